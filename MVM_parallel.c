@@ -4,91 +4,2829 @@
 #include <stdlib.h>
 #include <time.h>
 #include <string.h>
-#include <time.h>
+#include <stdint.h>
+#include <math.h>
 #include <omp.h>
+#include <inttypes.h>
+#include <limits.h>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HAVE_STREAM_STORES 1
+#else
+#define HAVE_STREAM_STORES 0
+#endif
+
+// ---------- Index width ----------
+// Two index types: nnz_t counts and addresses nonzeros (rowPtr, nnz), idx_t
+// holds rows and columns (colIndex, triplet indices). Both are 32-bit by
+// default. -DMVM_INDEX64 widens nnz_t only, for matrices with more than
+// 2^31 - 1 nonzeros, so colIndex stays at 4 bytes per nonzero. -DMVM_COL64
+// also widens idx_t, for dimensions beyond 2^31 - 1 (the loader tells you
+// which one a matrix needs).
+#if defined(MVM_INDEX64) || defined(MVM_COL64)
+typedef int64_t nnz_t;
+#define NNZ_FMT "%" PRId64
+#define NNZ_MAX INT64_MAX
+#else
+typedef int nnz_t;
+#define NNZ_FMT "%d"
+#define NNZ_MAX INT_MAX
+#endif
+#ifdef MVM_COL64
+typedef int64_t idx_t;
+#define IDX_FMT "%" PRId64
+#define IDX_SCN "%" SCNd64
+#define IDX_MAX INT64_MAX
+#else
+typedef int idx_t;
+#define IDX_FMT "%d"
+#define IDX_SCN "%d"
+#define IDX_MAX INT_MAX
+#endif
+
+typedef struct {
+    idx_t row;
+    idx_t col;
+    double val;
+} Triplet;
+
+// ---------- Arena allocator ----------
+// The triplets, the CSR arrays and the x/y vectors are cut from large regions
+// instead of separate malloc blocks. Every slice is 64-byte aligned. On Linux
+// a region is mapped with MAP_HUGETLB (explicit huge pages); if that fails it
+// is a normal mapping aligned to 2 MiB with madvise(MADV_HUGEPAGE), so the
+// kernel can back it with transparent huge pages. Other systems get a malloc'd
+// block. A new region is mapped when the current one is full; slices never
+// move and all regions are released together by arenaRelease.
+#define ARENA_ALIGN 64
+#define HUGE_PAGE ((size_t)2 << 20)
+#define ARENA_REGION ((size_t)32 << 20)  // minimum region size
+#define ARENA_MAX_REGIONS 64
+
+enum { ARENA_HUGETLB, ARENA_THP, ARENA_MALLOC };
+
+typedef struct {
+    char *base;       // 2 MiB (or 64-byte) aligned start
+    void *raw;        // what to munmap/free
+    size_t rawSize;
+    size_t size, used;
+    int kind;
+} ArenaRegion;
+
+typedef struct {
+    ArenaRegion region[ARENA_MAX_REGIONS];
+    int count;
+    size_t overflow;  // bytes that went to plain malloc
+} Arena;
+
+static Arena arena;
+
+static int arenaMapRegion(ArenaRegion *r, size_t bytes) {
+    bytes = (bytes + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+    r->size = bytes;
+    r->used = 0;
+#if defined(__linux__)
+#ifdef MAP_HUGETLB
+    void *p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED) {
+        r->raw = r->base = (char *)p;
+        r->rawSize = bytes;
+        r->kind = ARENA_HUGETLB;
+        return 1;
+    }
+#endif
+    // One extra huge page so the base can be moved to a 2 MiB boundary
+    void *q = mmap(NULL, bytes + HUGE_PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (q != MAP_FAILED) {
+        r->raw = q;
+        r->rawSize = bytes + HUGE_PAGE;
+        r->base = (char *)(((uintptr_t)q + HUGE_PAGE - 1) & ~(uintptr_t)(HUGE_PAGE - 1));
+#ifdef MADV_HUGEPAGE
+        madvise(r->base, bytes, MADV_HUGEPAGE);
+#endif
+        r->kind = ARENA_THP;
+        return 1;
+    }
+#endif
+    r->raw = malloc(bytes + ARENA_ALIGN);
+    if (!r->raw) return 0;
+    r->rawSize = bytes + ARENA_ALIGN;
+    r->base = (char *)(((uintptr_t)r->raw + ARENA_ALIGN - 1) & ~(uintptr_t)(ARENA_ALIGN - 1));
+    r->kind = ARENA_MALLOC;
+    return 1;
+}
+
+// 64-byte aligned, uninitialized; falls back to malloc when no region can be mapped
+void *arenaAlloc(size_t bytes) {
+    size_t need = (bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (need == 0) need = ARENA_ALIGN;
+    ArenaRegion *r = arena.count ? &arena.region[arena.count - 1] : NULL;
+    if (!r || r->size - r->used < need) {
+        r = NULL;
+        if (arena.count < ARENA_MAX_REGIONS &&
+            arenaMapRegion(&arena.region[arena.count], need > ARENA_REGION ? need : ARENA_REGION))
+            r = &arena.region[arena.count++];
+    }
+    if (!r) {
+        arena.overflow += bytes;
+        return malloc(bytes ? bytes : 1);
+    }
+    void *p = r->base + r->used;
+    r->used += need;
+    return p;
+}
+
+int arenaOwns(const void *p) {
+    for (int i = 0; i < arena.count; i++) {
+        const ArenaRegion *r = &arena.region[i];
+        if ((const char *)p >= r->base && (const char *)p < r->base + r->size) return 1;
+    }
+    return 0;
+}
+
+// free() for pointers that may be arena slices; those are released with arenaRelease
+void arenaFree(void *p) {
+    if (p && !arenaOwns(p)) free(p);
+}
+
+void arenaRelease(void) {
+    for (int i = 0; i < arena.count; i++) {
+        ArenaRegion *r = &arena.region[i];
+#if defined(__linux__)
+        if (r->kind != ARENA_MALLOC) munmap(r->raw, r->rawSize);
+        else free(r->raw);
+#else
+        free(r->raw);
+#endif
+    }
+    memset(&arena, 0, sizeof(arena));
+}
+
+// Share of the arena's resident memory on huge pages. Explicit huge pages
+// count in full; for the madvise'd regions /proc/self/smaps gives the Rss and
+// AnonHugePages of each mapping.
+void arenaReport(void) {
+    static const char *kinds[] = {"MAP_HUGETLB", "madvise(MADV_HUGEPAGE)", "malloc"};
+    size_t used = 0, mapped = 0;
+    double residentKb = 0.0, hugeKb = 0.0;
+    for (int i = 0; i < arena.count; i++) {
+        used += arena.region[i].used;
+        mapped += arena.region[i].size;
+        if (arena.region[i].kind == ARENA_HUGETLB) { // pages are faulted in as the slices are touched
+            size_t touched = (arena.region[i].used + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+            residentKb += touched / 1024.0;
+            hugeKb += touched / 1024.0;
+        }
+    }
+#if defined(__linux__)
+    FILE *f = fopen("/proc/self/smaps", "r");
+    if (f) {
+        char line[256];
+        const ArenaRegion *cur = NULL;
+        uintptr_t lo, hi;
+        while (fgets(line, sizeof(line), f)) {
+            if (sscanf(line, "%" SCNxPTR "-%" SCNxPTR, &lo, &hi) == 2) { // mapping header line
+                cur = NULL;
+                for (int i = 0; i < arena.count; i++) {
+                    uintptr_t b = (uintptr_t)arena.region[i].base;
+                    if (arena.region[i].kind == ARENA_THP && b >= lo && b < hi) cur = &arena.region[i];
+                }
+                continue;
+            }
+            if (!cur) continue;
+            if (strncmp(line, "Rss:", 4) == 0) residentKb += atof(line + 4);
+            else if (strncmp(line, "AnonHugePages:", 14) == 0) hugeKb += atof(line + 14);
+        }
+        fclose(f);
+    }
+#endif
+    printf("Arena: %d region(s) (%s), %.1f MiB used of %.1f MiB mapped, %.1f MiB outside the arena\n",
+           arena.count, arena.count ? kinds[arena.region[0].kind] : "none",
+           used / 1048576.0, mapped / 1048576.0, arena.overflow / 1048576.0);
+    if (residentKb > 0.0)
+        printf("  Huge-page coverage: %.1f%% of %.1f MiB resident\n", 100.0 * hugeKb / residentKb, residentKb / 1024.0);
+    else
+        printf("  Huge-page coverage: unknown (no /proc/self/smaps) or 4 KiB pages only\n");
+    fflush(stdout);
+}
+
+// ---------- Quick Sort ----------
+int cmpTriplet(const void *a, const void *b) {
+    const Triplet *ta = (const Triplet *)a;
+    const Triplet *tb = (const Triplet *)b;
+    if (ta->row != tb->row) return (ta->row > tb->row) - (ta->row < tb->row);
+    return (ta->col > tb->col) - (ta->col < tb->col);
+}
+
+// ---------- CSR Conversion ----------
+void convertToCSR(Triplet *triplets, nnz_t nnz, idx_t rows, idx_t cols,
+                  double **values, idx_t **colIndex, nnz_t **rowPtr) {
+    *values = (double *)arenaAlloc((size_t)nnz * sizeof(double));
+    *colIndex = (idx_t *)arenaAlloc((size_t)nnz * sizeof(idx_t));
+    *rowPtr = (nnz_t *)arenaAlloc(((size_t)rows + 1) * sizeof(nnz_t));
+
+    if (!(*values) || !(*colIndex) || !(*rowPtr)) {
+        printf("Error: memory allocation failed in CSR conversion.\n");
+        fflush(stdout);
+        exit(1);
+    }
+    memset(*rowPtr, 0, ((size_t)rows + 1) * sizeof(nnz_t));
+
+    for (nnz_t i = 0; i < nnz; i++) {
+        (*rowPtr)[triplets[i].row + 1]++;
+    }
+    for (idx_t i = 0; i < rows; i++) {
+        (*rowPtr)[i + 1] += (*rowPtr)[i];
+    }
+
+    // We fill from the end of each row bucket, so make a copy of rowPtr to use as write pointers
+    nnz_t *writePtr = (nnz_t *)malloc(((size_t)rows + 1) * sizeof(nnz_t));
+    if (!writePtr) {
+        printf("Error: memory allocation failed in CSR conversion (writePtr).\n");
+        fflush(stdout);
+        exit(1);
+    }
+    for (idx_t i = 0; i <= rows; i++) writePtr[i] = (*rowPtr)[i];
+
+    for (nnz_t i = 0; i < nnz; i++) {
+        idx_t row = triplets[i].row;
+        nnz_t dest = writePtr[row];
+        (*values)[dest] = triplets[i].val;
+        (*colIndex)[dest] = triplets[i].col;
+        writePtr[row]++;
+    }
+
+    free(writePtr);
+}
+
+// ---------- Matrix-Vector Multiplication (parallelized with OpenMP) ----------
+void csrMatVecMultiply(idx_t rows, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                       double *x, double *y) {
+    // Each row is independent so we parallelize over rows.
+    #pragma omp parallel for schedule(runtime)
+    for (idx_t i = 0; i < rows; i++) {
+        double sum = 0.0;
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++) {
+            sum += values[j] * x[colIndex[j]];
+        }
+        y[i] = sum;
+    }
+}
+
+// ---------- Time in milliseconds ----------
+double getMilliseconds() {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);  // get current time in UTC
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6; // convert to milliseconds
+}
+
+// ---------- Reduced-precision value storage ----------
+// Only the stored matrix values lose precision; x, y and the row sums stay
+// in double. bfloat16 keeps the upper 16 bits of a float (round to nearest even).
+enum { PREC_DOUBLE, PREC_FLOAT, PREC_BF16 };
+
+uint16_t floatToBF16(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    bits += 0x7FFF + ((bits >> 16) & 1);
+    return (uint16_t)(bits >> 16);
+}
+
+static inline double bf16ToDouble(uint16_t h) {
+    uint32_t bits = (uint32_t)h << 16;
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return (double)f;
+}
+
+void csrMatVecMultiplyFloat(idx_t rows, float *values, idx_t *colIndex, nnz_t *rowPtr,
+                            double *x, double *y) {
+    #pragma omp parallel for schedule(runtime)
+    for (idx_t i = 0; i < rows; i++) {
+        double sum = 0.0;
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++) {
+            sum += (double)values[j] * x[colIndex[j]];
+        }
+        y[i] = sum;
+    }
+}
+
+void csrMatVecMultiplyBF16(idx_t rows, uint16_t *values, idx_t *colIndex, nnz_t *rowPtr,
+                           double *x, double *y) {
+    #pragma omp parallel for schedule(runtime)
+    for (idx_t i = 0; i < rows; i++) {
+        double sum = 0.0;
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++) {
+            sum += bf16ToDouble(values[j]) * x[colIndex[j]];
+        }
+        y[i] = sum;
+    }
+}
+
+// Dispatch on the storage precision chosen with -p
+void csrMatVecMultiplyPrec(int prec, idx_t rows, double *values, float *valuesF,
+                           uint16_t *valuesH, idx_t *colIndex, nnz_t *rowPtr,
+                           double *x, double *y) {
+    if (prec == PREC_FLOAT)
+        csrMatVecMultiplyFloat(rows, valuesF, colIndex, rowPtr, x, y);
+    else if (prec == PREC_BF16)
+        csrMatVecMultiplyBF16(rows, valuesH, colIndex, rowPtr, x, y);
+    else
+        csrMatVecMultiply(rows, values, colIndex, rowPtr, x, y);
+}
+
+// Max |y_low - y_ref| relative to ||y_ref||_inf over a few random x vectors
+double precisionError(int prec, idx_t rows, idx_t cols, double *values, float *valuesF,
+                      uint16_t *valuesH, idx_t *colIndex, nnz_t *rowPtr,
+                      double *x, double *y, double *yRef, int samples) {
+    double maxErr = 0.0;
+    for (int s = 0; s < samples; s++) {
+        for (idx_t j = 0; j < cols; j++)
+            x[j] = (double)rand() / RAND_MAX;
+        csrMatVecMultiply(rows, values, colIndex, rowPtr, x, yRef);
+        csrMatVecMultiplyPrec(prec, rows, values, valuesF, valuesH, colIndex, rowPtr, x, y);
+        double diff = 0.0, norm = 0.0;
+        for (idx_t i = 0; i < rows; i++) {
+            if (fabs(y[i] - yRef[i]) > diff) diff = fabs(y[i] - yRef[i]);
+            if (fabs(yRef[i]) > norm) norm = fabs(yRef[i]);
+        }
+        double err = (norm > 0.0) ? diff / norm : diff;
+        if (err > maxErr) maxErr = err;
+    }
+    return maxErr;
+}
+
+// ---------- Sparse Matrix x Dense Block (SpMM) ----------
+// Y = A X with X (cols x k) and Y (rows x k) stored row-major, so the k
+// entries a nonzero multiplies are contiguous. Every nonzero is loaded once
+// for all k vectors. The widths 2, 4, 8 and 16 are compiled with a constant
+// k so the inner loop is fully unrolled / vectorized; other k use the
+// generic kernel.
+#define DEFINE_CSR_SPMM(K)                                                     \
+void csrSpMM##K(idx_t rows, double *values, idx_t *colIndex, nnz_t *rowPtr,    \
+                const double *X, double *Y) {                                  \
+    _Pragma("omp parallel for schedule(runtime)")                              \
+    for (idx_t i = 0; i < rows; i++) {                                         \
+        double acc[K] = {0.0};                                                 \
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++) {                    \
+            double v = values[j];                                              \
+            const double *xr = X + (size_t)colIndex[j] * K;                    \
+            _Pragma("omp simd")                                                \
+            for (int t = 0; t < K; t++) acc[t] += v * xr[t];                   \
+        }                                                                      \
+        double *yr = Y + (size_t)i * K;                                        \
+        for (int t = 0; t < K; t++) yr[t] = acc[t];                            \
+    }                                                                          \
+}
+
+DEFINE_CSR_SPMM(2)
+DEFINE_CSR_SPMM(4)
+DEFINE_CSR_SPMM(8)
+DEFINE_CSR_SPMM(16)
+
+void csrSpMMGeneric(idx_t rows, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                    int k, const double *X, double *Y) {
+    #pragma omp parallel for schedule(runtime)
+    for (idx_t i = 0; i < rows; i++) {
+        double *yr = Y + (size_t)i * k;
+        for (int t = 0; t < k; t++) yr[t] = 0.0;
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++) {
+            double v = values[j];
+            const double *xr = X + (size_t)colIndex[j] * k;
+            #pragma omp simd
+            for (int t = 0; t < k; t++) yr[t] += v * xr[t];
+        }
+    }
+}
+
+void csrSpMM(idx_t rows, double *values, idx_t *colIndex, nnz_t *rowPtr,
+             int k, const double *X, double *Y) {
+    switch (k) {
+        case 2:  csrSpMM2(rows, values, colIndex, rowPtr, X, Y); break;
+        case 4:  csrSpMM4(rows, values, colIndex, rowPtr, X, Y); break;
+        case 8:  csrSpMM8(rows, values, colIndex, rowPtr, X, Y); break;
+        case 16: csrSpMM16(rows, values, colIndex, rowPtr, X, Y); break;
+        default: csrSpMMGeneric(rows, values, colIndex, rowPtr, k, X, Y); break;
+    }
+}
+
+// Times the SpMM against k separate csrMatVecMultiply calls on the same block.
+// times[] receives the SpMM time of every run.
+int benchmarkSpMM(idx_t rows, idx_t cols, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                  int k, int runs, double *times) {
+    nnz_t nnz = rowPtr[rows];
+    double *X = (double *)malloc((size_t)cols * k * sizeof(double));
+    double *Y = (double *)malloc((size_t)rows * k * sizeof(double));
+    double *xv = (double *)malloc((size_t)cols * sizeof(double));
+    double *yv = (double *)malloc((size_t)rows * sizeof(double));
+    if (!X || !Y || !xv || !yv) {
+        printf("Error: memory allocation failed for SpMM blocks.\n");
+        fflush(stdout);
+        free(X); free(Y); free(xv); free(yv);
+        return 0;
+    }
+
+    // Check every column of Y against a single SpMV once
+    for (size_t j = 0; j < (size_t)cols * k; j++)
+        X[j] = (double)rand() / RAND_MAX;
+    csrSpMM(rows, values, colIndex, rowPtr, k, X, Y);
+    double maxDiff = 0.0;
+    for (int t = 0; t < k; t++) {
+        for (idx_t j = 0; j < cols; j++) xv[j] = X[(size_t)j * k + t];
+        csrMatVecMultiply(rows, values, colIndex, rowPtr, xv, yv);
+        for (idx_t i = 0; i < rows; i++)
+            if (fabs(Y[(size_t)i * k + t] - yv[i]) > maxDiff) maxDiff = fabs(Y[(size_t)i * k + t] - yv[i]);
+    }
+    printf("SpMM k=%d: max abs difference vs csrMatVecMultiply: %.3e\n", k, maxDiff);
+
+    printf("\nRunning %d SpMM (k=%d) multiplications (parallel)...\n", runs, k);
+    fflush(stdout);
+
+    double best = 0.0, bestSpmv = 0.0;
+    for (int r = 0; r < runs; r++) {
+        for (size_t j = 0; j < (size_t)cols * k; j++)
+            X[j] = (double)rand() / RAND_MAX;
+
+        double start = getMilliseconds();
+        csrSpMM(rows, values, colIndex, rowPtr, k, X, Y);
+        double end = getMilliseconds();
+        times[r] = end - start;
+
+        // Same work as k independent SpMVs
+        double spmv = 0.0;
+        for (int t = 0; t < k; t++) {
+            for (idx_t j = 0; j < cols; j++) xv[j] = X[(size_t)j * k + t];
+            double s0 = getMilliseconds();
+            csrMatVecMultiply(rows, values, colIndex, rowPtr, xv, yv);
+            spmv += getMilliseconds() - s0;
+        }
+
+        printf("Run %d: %.6f ms   (%d x SpMV: %.6f ms)\n", r + 1, times[r], k, spmv);
+        fflush(stdout);
+        if (r == 0 || times[r] < best) best = times[r];
+        if (r == 0 || spmv < bestSpmv) bestSpmv = spmv;
+    }
+
+    // 2*nnz flops per vector; GFLOP/s are summed over the k vectors
+    double flops = 2.0 * (double)nnz * k;
+    printf("\nSpMM k=%d best run: %.6f ms (%.6f ms per vector), %.3f GFLOP/s\n",
+           k, best, best / k, flops / (best * 1e6));
+    printf("%d x SpMV best run: %.6f ms (%.6f ms per vector), %.3f GFLOP/s  (SpMM speedup %.3f)\n",
+           k, bestSpmv, bestSpmv / k, flops / (bestSpmv * 1e6), bestSpmv / best);
+    fflush(stdout);
+
+    free(X); free(Y); free(xv); free(yv);
+    return 1;
+}
+
+// ---------- Transpose Multiplication (y = A^T x) ----------
+// Two ways to compute A^T x from the CSR arrays:
+//  - scatter: rows are split over threads and each thread scatters
+//    values[j] * x[i] into a private copy of y (thread 0 uses y itself),
+//    followed by a parallel reduction over the columns. No extra matrix
+//    storage, but the private buffers cost threads * cols doubles.
+//  - csc: a CSC copy (= CSR of A^T), built once in parallel and cached,
+//    after which A^T x is a plain row-parallel gather with no reduction.
+enum { TRANS_AUTO, TRANS_SCATTER, TRANS_CSC };
+
+typedef struct {
+    int built;
+    double *values;
+    idx_t *rowIndex;
+    nnz_t *colPtr;
+    double buildMs;
+} CSCCache;
+
+// Parallel CSR -> CSC. Each thread counts the columns of a static block of
+// rows; the per-thread counts give every thread its own write offsets, so
+// row indices stay sorted inside each column without atomics.
+void buildCSC(idx_t rows, idx_t cols, double *values, idx_t *colIndex, nnz_t *rowPtr,
+              CSCCache *csc) {
+    if (csc->built) return;
+    double start = getMilliseconds();
+    nnz_t nnz = rowPtr[rows];
+    int nthreads = omp_get_max_threads();
+    nnz_t *counts = (nnz_t *)calloc((size_t)nthreads * (cols + 1), sizeof(nnz_t));
+    csc->values = (double *)malloc((size_t)nnz * sizeof(double));
+    csc->rowIndex = (idx_t *)malloc((size_t)nnz * sizeof(idx_t));
+    csc->colPtr = (nnz_t *)calloc((size_t)cols + 1, sizeof(nnz_t));
+    if (!counts || !csc->values || !csc->rowIndex || !csc->colPtr) {
+        printf("Error: memory allocation failed in CSC conversion.\n");
+        fflush(stdout);
+        exit(1);
+    }
+
+    #pragma omp parallel num_threads(nthreads)
+    {
+        int t = omp_get_thread_num();
+        nnz_t *cnt = counts + (size_t)t * (cols + 1);
+        #pragma omp for schedule(static)
+        for (idx_t i = 0; i < rows; i++)
+            for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+                cnt[colIndex[j]]++;
+
+        // Column totals, then turn each thread's count into its start offset
+        #pragma omp for schedule(static)
+        for (idx_t c = 0; c < cols; c++) {
+            nnz_t sum = 0;
+            for (int u = 0; u < nthreads; u++) {
+                nnz_t v = counts[(size_t)u * (cols + 1) + c];
+                counts[(size_t)u * (cols + 1) + c] = sum;
+                sum += v;
+            }
+            csc->colPtr[c + 1] = sum;
+        }
+
+        #pragma omp single
+        for (idx_t c = 0; c < cols; c++)
+            csc->colPtr[c + 1] += csc->colPtr[c];
+
+        #pragma omp for schedule(static)
+        for (idx_t i = 0; i < rows; i++)
+            for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++) {
+                idx_t c = colIndex[j];
+                nnz_t dest = csc->colPtr[c] + cnt[c]++;
+                csc->values[dest] = values[j];
+                csc->rowIndex[dest] = i;
+            }
+    }
+
+    free(counts);
+    csc->built = 1;
+    csc->buildMs = getMilliseconds() - start;
+}
+
+void freeCSC(CSCCache *csc) {
+    if (!csc->built) return;
+    free(csc->values);
+    free(csc->rowIndex);
+    free(csc->colPtr);
+    csc->built = 0;
+}
+
+// Called inside a parallel region: adds the private buffers of threads
+// 1..n-1 into y (thread 0's buffer), split over the columns.
+static void reduceThreadBuffers(idx_t cols, double *y, const double *yPriv) {
+    int nthreads = omp_get_num_threads();
+    if (nthreads == 1) return;
+    #pragma omp for schedule(static)
+    for (idx_t c = 0; c < cols; c++) {
+        double sum = y[c];
+        for (int u = 0; u < nthreads - 1; u++)
+            sum += yPriv[(size_t)u * cols + c];
+        y[c] = sum;
+    }
+}
+
+// yPriv holds (threads - 1) * cols doubles for the threads other than 0
+void csrTransMatVecScatter(idx_t rows, idx_t cols, double *values, idx_t *colIndex,
+                           nnz_t *rowPtr, double *x, double *y, double *yPriv) {
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num();
+        double *yt = (t == 0) ? y : yPriv + (size_t)(t - 1) * cols;
+        for (idx_t c = 0; c < cols; c++) yt[c] = 0.0;
+
+        #pragma omp for schedule(runtime)
+        for (idx_t i = 0; i < rows; i++) {
+            double xi = x[i];
+            for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+                yt[colIndex[j]] += values[j] * xi;
+        }
+
+        reduceThreadBuffers(cols, y, yPriv);
+    }
+}
+
+// ---------- Fused A x and A^T y (one pass over the matrix) ----------
+// ax = A x and aty = A^T u, reading every row of values/colIndex once.
+// With u == NULL the row's own result is scattered, i.e. aty = A^T (A x),
+// the product needed by CGLS/LSQR on the normal equations. The scatter uses
+// the same private buffers and reduction as csrTransMatVecScatter.
+void csrFusedAxAty(idx_t rows, idx_t cols, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                   double *x, double *u, double *ax, double *aty, double *priv) {
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num();
+        double *zt = (t == 0) ? aty : priv + (size_t)(t - 1) * cols;
+        for (idx_t c = 0; c < cols; c++) zt[c] = 0.0;
+
+        #pragma omp for schedule(runtime)
+        for (idx_t i = 0; i < rows; i++) {
+            double sum = 0.0;
+            for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+                sum += values[j] * x[colIndex[j]];
+            ax[i] = sum;
+            // The row is still in cache from the dot product
+            double ui = u ? u[i] : sum;
+            for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+                zt[colIndex[j]] += values[j] * ui;
+        }
+
+        reduceThreadBuffers(cols, aty, priv);
+    }
+}
+
+// Times the fused kernel against A x followed by A^T (scatter) on the same data.
+// u == NULL benchmarks A^T A x, otherwise the A x / A^T u pair.
+int benchmarkFused(idx_t rows, idx_t cols, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                   int pair, int runs, double *times) {
+    int threads = omp_get_max_threads();
+    double *x = (double *)malloc((size_t)cols * sizeof(double));
+    double *u = (double *)malloc((size_t)rows * sizeof(double));
+    double *ax = (double *)malloc((size_t)rows * sizeof(double));
+    double *aty = (double *)malloc((size_t)cols * sizeof(double));
+    double *axRef = (double *)malloc((size_t)rows * sizeof(double));
+    double *atyRef = (double *)malloc((size_t)cols * sizeof(double));
+    double *priv = (double *)malloc(((size_t)(threads > 1 ? threads - 1 : 1)) * cols * sizeof(double));
+    if (!x || !u || !ax || !aty || !axRef || !atyRef || !priv) {
+        printf("Error: memory allocation failed for fused kernel vectors.\n");
+        fflush(stdout);
+        return 0;
+    }
+
+    printf("\nRunning %d fused %s multiplications (parallel)...\n", runs,
+           pair ? "A x / A^T u" : "A^T A x");
+    fflush(stdout);
+
+    double best = 0.0, bestRef = 0.0, maxDiff = 0.0;
+    for (int r = 0; r < runs; r++) {
+        for (idx_t j = 0; j < cols; j++) x[j] = (double)rand() / RAND_MAX;
+        for (idx_t i = 0; i < rows; i++) u[i] = (double)rand() / RAND_MAX;
+
+        double start = getMilliseconds();
+        csrFusedAxAty(rows, cols, values, colIndex, rowPtr, x, pair ? u : NULL, ax, aty, priv);
+        double mid = getMilliseconds();
+        csrMatVecMultiply(rows, values, colIndex, rowPtr, x, axRef);
+        csrTransMatVecScatter(rows, cols, values, colIndex, rowPtr, pair ? u : axRef, atyRef, priv);
+        double end = getMilliseconds();
+
+        times[r] = mid - start;
+        double ref = end - mid;
+        double norm = 0.0, diff = 0.0;
+        for (idx_t c = 0; c < cols; c++) {
+            if (fabs(aty[c] - atyRef[c]) > diff) diff = fabs(aty[c] - atyRef[c]);
+            if (fabs(atyRef[c]) > norm) norm = fabs(atyRef[c]);
+        }
+        if (norm > 0.0) diff /= norm;
+        if (diff > maxDiff) maxDiff = diff;
+
+        printf("Run %d: %.6f ms   (unfused: %.6f ms)\n", r + 1, times[r], ref);
+        fflush(stdout);
+        if (r == 0 || times[r] < best) best = times[r];
+        if (r == 0 || ref < bestRef) bestRef = ref;
+    }
+
+    printf("\nFused best: %.6f ms, unfused best: %.6f ms (speedup %.3f), max rel. difference %.3e\n",
+           best, bestRef, bestRef / best, maxDiff);
+    fflush(stdout);
+
+    free(x); free(u); free(ax); free(aty); free(axRef); free(atyRef); free(priv);
+    return 1;
+}
+
+void cscTransMatVecMultiply(idx_t cols, const CSCCache *csc, double *x, double *y) {
+    csrMatVecMultiply(cols, csc->values, csc->rowIndex, csc->colPtr, x, y);
+}
+
+// Scatter while the private buffers are cheaper to zero and reduce than the
+// matrix is to stream; beyond that the one-off CSC build pays for itself.
+int chooseTransMethod(idx_t rows, idx_t cols, nnz_t nnz, int threads) {
+    if (threads <= 1) return TRANS_SCATTER;
+    double matrixBytes = (double)nnz * (sizeof(double) + sizeof(idx_t)) + (double)rows * sizeof(nnz_t);
+    double reduceBytes = 2.0 * (double)(threads - 1) * cols * sizeof(double);
+    return (reduceBytes > matrixBytes) ? TRANS_CSC : TRANS_SCATTER;
+}
+
+// Runs A^T x with the chosen method, checks it against the other one once.
+int benchmarkTranspose(idx_t rows, idx_t cols, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                       int method, int runs, double *times) {
+    int threads = omp_get_max_threads();
+    if (method == TRANS_AUTO)
+        method = chooseTransMethod(rows, cols, rowPtr[rows], threads);
+    printf("Transpose method: %s\n", method == TRANS_CSC ? "csc (cached copy)" : "scatter (private y)");
+
+    double *x = (double *)malloc((size_t)rows * sizeof(double));
+    double *y = (double *)malloc((size_t)cols * sizeof(double));
+    double *yRef = (double *)malloc((size_t)cols * sizeof(double));
+    double *yPriv = (double *)malloc(((size_t)(threads > 1 ? threads - 1 : 1)) * cols * sizeof(double));
+    if (!x || !y || !yRef || !yPriv) {
+        printf("Error: memory allocation failed for transpose vectors.\n");
+        fflush(stdout);
+        return 0;
+    }
+
+    CSCCache csc = {0};
+    buildCSC(rows, cols, values, colIndex, rowPtr, &csc);
+    printf("CSC build time: %.6f ms\n", csc.buildMs);
+
+    for (idx_t i = 0; i < rows; i++) x[i] = (double)rand() / RAND_MAX;
+    csrTransMatVecScatter(rows, cols, values, colIndex, rowPtr, x, y, yPriv);
+    cscTransMatVecMultiply(cols, &csc, x, yRef);
+    double maxDiff = 0.0;
+    for (idx_t c = 0; c < cols; c++)
+        if (fabs(y[c] - yRef[c]) > maxDiff) maxDiff = fabs(y[c] - yRef[c]);
+    printf("Max abs difference scatter vs csc: %.3e\n", maxDiff);
+    if (method == TRANS_SCATTER) freeCSC(&csc);
+
+    printf("\nRunning %d transpose multiplications (parallel)...\n", runs);
+    fflush(stdout);
+    for (int r = 0; r < runs; r++) {
+        for (idx_t i = 0; i < rows; i++) x[i] = (double)rand() / RAND_MAX;
+        double start = getMilliseconds();
+        if (method == TRANS_CSC)
+            cscTransMatVecMultiply(cols, &csc, x, y);
+        else
+            csrTransMatVecScatter(rows, cols, values, colIndex, rowPtr, x, y, yPriv);
+        double end = getMilliseconds();
+        times[r] = end - start;
+        printf("Run %d: %.6f ms\n", r + 1, times[r]);
+        fflush(stdout);
+    }
+
+    freeCSC(&csc);
+    free(x); free(y); free(yRef); free(yPriv);
+    return 1;
+}
+
+// ---------- Conjugate Gradient ----------
+// Row dot product for the -p storage precision, for kernels that run the row
+// loop inside their own parallel region.
+static inline double csrRowDotPrec(int prec, idx_t i, const double *values, const float *valuesF,
+                                   const uint16_t *valuesH, const idx_t *colIndex,
+                                   const nnz_t *rowPtr, const double *x) {
+    double sum = 0.0;
+    if (prec == PREC_FLOAT) {
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+            sum += (double)valuesF[j] * x[colIndex[j]];
+    } else if (prec == PREC_BF16) {
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+            sum += bf16ToDouble(valuesH[j]) * x[colIndex[j]];
+    } else {
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+            sum += values[j] * x[colIndex[j]];
+    }
+    return sum;
+}
+
+typedef struct {
+    int iters;
+    double relRes;  // recursive ||r|| / ||b||
+    double spmvMs;  // summed over iterations
+    double vecMs;
+} CGStats;
+
+// CG for symmetric positive definite A, starting from x = 0. Every iteration
+// is a single parallel region: q = A p with p.q accumulated in the same row
+// loop, then x += alpha p, r -= alpha q with r.r, then p = r + beta p.
+// alpha and beta are computed by every thread from the reduced scalars.
+// Returns 0 on convergence or maxIter, -1 if p.Ap <= 0 (A not SPD).
+int cgSolve(int prec, idx_t n, double *values, float *valuesF, uint16_t *valuesH,
+            idx_t *colIndex, nnz_t *rowPtr, const double *b, double *x,
+            double *r, double *p, double *q, int maxIter, double tol, CGStats *st) {
+    double bb = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:bb)
+    for (idx_t i = 0; i < n; i++) {
+        x[i] = 0.0;
+        r[i] = b[i];
+        p[i] = b[i];
+        bb += b[i] * b[i];
+    }
+
+    double rr = bb;
+    st->iters = 0;
+    st->spmvMs = st->vecMs = 0.0;
+    while (st->iters < maxIter && rr > tol * tol * bb) {
+        double pq = 0.0, rrNew = 0.0, tMid = 0.0;
+        double t0 = getMilliseconds();
+        #pragma omp parallel
+        {
+            #pragma omp for schedule(runtime) reduction(+:pq)
+            for (idx_t i = 0; i < n; i++) {
+                double qi = csrRowDotPrec(prec, i, values, valuesF, valuesH, colIndex, rowPtr, p);
+                q[i] = qi;
+                pq += p[i] * qi;
+            }
+            #pragma omp master
+            tMid = getMilliseconds();
+
+            double alpha = rr / pq;
+            #pragma omp for schedule(static) reduction(+:rrNew)
+            for (idx_t i = 0; i < n; i++) {
+                x[i] += alpha * p[i];
+                r[i] -= alpha * q[i];
+                rrNew += r[i] * r[i];
+            }
+
+            double beta = rrNew / rr;
+            #pragma omp for schedule(static)
+            for (idx_t i = 0; i < n; i++)
+                p[i] = r[i] + beta * p[i];
+        }
+        double t1 = getMilliseconds();
+        st->spmvMs += tMid - t0;
+        st->vecMs += t1 - tMid;
+        st->iters++;
+        if (pq <= 0.0) {
+            st->relRes = sqrt(rrNew / bb);
+            return -1;
+        }
+        rr = rrNew;
+    }
+    st->relRes = (bb > 0.0) ? sqrt(rr / bb) : 0.0;
+    return 0;
+}
+
+// Solves A x = A * ones with CG once per run and reports the per-iteration split.
+int benchmarkCG(int prec, idx_t n, double *values, float *valuesF, uint16_t *valuesH,
+                idx_t *colIndex, nnz_t *rowPtr, int maxIter, double tol,
+                int runs, double *times) {
+    double *b = (double *)malloc((size_t)n * sizeof(double));
+    double *x = (double *)malloc((size_t)n * sizeof(double));
+    double *r = (double *)malloc((size_t)n * sizeof(double));
+    double *p = (double *)malloc((size_t)n * sizeof(double));
+    double *q = (double *)malloc((size_t)n * sizeof(double));
+    if (!b || !x || !r || !p || !q) {
+        printf("Error: memory allocation failed for CG vectors.\n");
+        fflush(stdout);
+        return 0;
+    }
+
+    // Right-hand side for the exact solution x = 1, same storage precision as the solve
+    for (idx_t i = 0; i < n; i++) x[i] = 1.0;
+    csrMatVecMultiplyPrec(prec, n, values, valuesF, valuesH, colIndex, rowPtr, x, b);
+
+    printf("\nRunning %d CG solves (parallel, maxit=%d, tol=%.1e)...\n", runs, maxIter, tol);
+    fflush(stdout);
+
+    CGStats st = {0};
+    int status = 0;
+    for (int run = 0; run < runs; run++) {
+        double start = getMilliseconds();
+        status = cgSolve(prec, n, values, valuesF, valuesH, colIndex, rowPtr,
+                         b, x, r, p, q, maxIter, tol, &st);
+        double end = getMilliseconds();
+        times[run] = end - start;
+        printf("Run %d: %.6f ms   (%d iterations, %.6f ms/iter)\n",
+               run + 1, times[run], st.iters, times[run] / (st.iters > 0 ? st.iters : 1));
+        fflush(stdout);
+    }
+
+    if (status < 0)
+        printf("CG breakdown: p.Ap <= 0 at iteration %d, the matrix is not SPD.\n", st.iters);
+
+    // True residual and error of the last solve, outside the timed loop
+    csrMatVecMultiplyPrec(prec, n, values, valuesF, valuesH, colIndex, rowPtr, x, q);
+    double res = 0.0, bnorm = 0.0, err = 0.0;
+    for (idx_t i = 0; i < n; i++) {
+        res += (b[i] - q[i]) * (b[i] - q[i]);
+        bnorm += b[i] * b[i];
+        if (fabs(x[i] - 1.0) > err) err = fabs(x[i] - 1.0);
+    }
+    int it = st.iters > 0 ? st.iters : 1;
+    printf("\nCG: %d iterations, recursive residual %.3e, true residual %.3e, max |x - 1| %.3e\n",
+           st.iters, st.relRes, bnorm > 0.0 ? sqrt(res / bnorm) : 0.0, err);
+    printf("Per iteration (last run): SpMV + p.Ap %.6f ms, vector ops %.6f ms (%.1f%% of iteration)\n",
+           st.spmvMs / it, st.vecMs / it, 100.0 * st.vecMs / (st.spmvMs + st.vecMs));
+    fflush(stdout);
+
+    free(b); free(x); free(r); free(p); free(q);
+    return 1;
+}
+
+// ---------- Fused SpMV + dot product (+ axpy) ----------
+// One partial sum per thread, each on its own cache line so the threads
+// never write to the same line.
+#define CACHE_LINE 64
+typedef struct {
+    double v;
+    char pad[CACHE_LINE - sizeof(double)];
+} PaddedSum;
+
+// y = A x and returns <x, y> (A square). If r is not NULL also r -= alpha * y.
+// Everything happens in the SpMV's row loop: y[i] is used while it is still in
+// a register, and the partial sums go to slots[thread] (at least
+// omp_get_max_threads() entries) and are added after the join, so there is
+// no second pass over y and no extra barrier for a reduction.
+double csrMatVecDot(idx_t rows, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                    double *x, double *y, double alpha, double *r, PaddedSum *slots) {
+    int nthreads = 1;
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num();
+        if (t == 0) nthreads = omp_get_num_threads();
+        double dot = 0.0;
+        #pragma omp for schedule(runtime) nowait
+        for (idx_t i = 0; i < rows; i++) {
+            double sum = 0.0;
+            for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+                sum += values[j] * x[colIndex[j]];
+            y[i] = sum;
+            dot += x[i] * sum;
+            if (r) r[i] -= alpha * sum;
+        }
+        slots[t].v = dot;
+    }
+    double dot = 0.0;
+    for (int t = 0; t < nthreads; t++) dot += slots[t].v;
+    return dot;
+}
+
+// Times csrMatVecDot (with the axpy) against SpMV, dot and axpy as three parallel loops.
+int benchmarkDot(idx_t rows, idx_t cols, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                 int runs, double *times) {
+    if (rows != cols) {
+        printf("Error: -op dot needs a square matrix.\n");
+        fflush(stdout);
+        return 0;
+    }
+    double *x = (double *)malloc((size_t)rows * sizeof(double));
+    double *y = (double *)malloc((size_t)rows * sizeof(double));
+    double *r = (double *)malloc((size_t)rows * sizeof(double));
+    double *rRef = (double *)malloc((size_t)rows * sizeof(double));
+    PaddedSum *slots = (PaddedSum *)malloc((size_t)omp_get_max_threads() * sizeof(PaddedSum));
+    if (!x || !y || !r || !rRef || !slots) {
+        printf("Error: memory allocation failed for fused dot vectors.\n");
+        fflush(stdout);
+        return 0;
+    }
+    const double alpha = 0.5;
+
+    printf("\nRunning %d fused y = A x, <x, y>, r -= alpha y (parallel)...\n", runs);
+    fflush(stdout);
+
+    double best = 0.0, bestRef = 0.0, maxDiff = 0.0;
+    for (int run = 0; run < runs; run++) {
+        for (idx_t i = 0; i < rows; i++) {
+            x[i] = (double)rand() / RAND_MAX;
+            r[i] = rRef[i] = (double)rand() / RAND_MAX;
+        }
+
+        double start = getMilliseconds();
+        double dot = csrMatVecDot(rows, values, colIndex, rowPtr, x, y, alpha, r, slots);
+        double mid = getMilliseconds();
+        csrMatVecMultiply(rows, values, colIndex, rowPtr, x, y);
+        double dotRef = 0.0;
+        #pragma omp parallel for schedule(static) reduction(+:dotRef)
+        for (idx_t i = 0; i < rows; i++) dotRef += x[i] * y[i];
+        #pragma omp parallel for schedule(static)
+        for (idx_t i = 0; i < rows; i++) rRef[i] -= alpha * y[i];
+        double end = getMilliseconds();
+
+        times[run] = mid - start;
+        double ref = end - mid;
+        double diff = fabs(dot - dotRef) / (fabs(dotRef) > 0.0 ? fabs(dotRef) : 1.0);
+        for (idx_t i = 0; i < rows; i++)
+            if (fabs(r[i] - rRef[i]) > diff) diff = fabs(r[i] - rRef[i]);
+        if (diff > maxDiff) maxDiff = diff;
+
+        printf("Run %d: %.6f ms   (unfused: %.6f ms)\n", run + 1, times[run], ref);
+        fflush(stdout);
+        if (run == 0 || times[run] < best) best = times[run];
+        if (run == 0 || ref < bestRef) bestRef = ref;
+    }
+
+    printf("\nFused best: %.6f ms, unfused best: %.6f ms (speedup %.3f), max difference %.3e\n",
+           best, bestRef, bestRef / best, maxDiff);
+    fflush(stdout);
+
+    free(x); free(y); free(r); free(rRef); free(slots);
+    return 1;
+}
+
+// ---------- Fused residual r = b - A x ----------
+// Writes r and returns ||r||^2 in one pass over the rows, with the same
+// padded per-thread slots as csrMatVecDot.
+double csrResidual(idx_t rows, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                   double *x, double *b, double *r, PaddedSum *slots) {
+    int nthreads = 1;
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num();
+        if (t == 0) nthreads = omp_get_num_threads();
+        double nrm = 0.0;
+        #pragma omp for schedule(runtime) nowait
+        for (idx_t i = 0; i < rows; i++) {
+            double sum = 0.0;
+            for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+                sum += values[j] * x[colIndex[j]];
+            double ri = b[i] - sum;
+            r[i] = ri;
+            nrm += ri * ri;
+        }
+        slots[t].v = nrm;
+    }
+    double nrm = 0.0;
+    for (int t = 0; t < nthreads; t++) nrm += slots[t].v;
+    return nrm;
+}
+
+// Times csrResidual against SpMV, subtraction and norm as three parallel loops.
+int benchmarkResidual(idx_t rows, idx_t cols, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                      int runs, double *times) {
+    double *x = (double *)malloc((size_t)cols * sizeof(double));
+    double *b = (double *)malloc((size_t)rows * sizeof(double));
+    double *r = (double *)malloc((size_t)rows * sizeof(double));
+    double *rRef = (double *)malloc((size_t)rows * sizeof(double));
+    PaddedSum *slots = (PaddedSum *)malloc((size_t)omp_get_max_threads() * sizeof(PaddedSum));
+    if (!x || !b || !r || !rRef || !slots) {
+        printf("Error: memory allocation failed for residual vectors.\n");
+        fflush(stdout);
+        return 0;
+    }
+
+    printf("\nRunning %d fused residuals r = b - A x, ||r||^2 (parallel)...\n", runs);
+    fflush(stdout);
+
+    double best = 0.0, bestRef = 0.0, maxDiff = 0.0;
+    for (int run = 0; run < runs; run++) {
+        for (idx_t j = 0; j < cols; j++) x[j] = (double)rand() / RAND_MAX;
+        for (idx_t i = 0; i < rows; i++) b[i] = (double)rand() / RAND_MAX;
+
+        double start = getMilliseconds();
+        double nrm = csrResidual(rows, values, colIndex, rowPtr, x, b, r, slots);
+        double mid = getMilliseconds();
+        csrMatVecMultiply(rows, values, colIndex, rowPtr, x, rRef);
+        #pragma omp parallel for schedule(static)
+        for (idx_t i = 0; i < rows; i++) rRef[i] = b[i] - rRef[i];
+        double nrmRef = 0.0;
+        #pragma omp parallel for schedule(static) reduction(+:nrmRef)
+        for (idx_t i = 0; i < rows; i++) nrmRef += rRef[i] * rRef[i];
+        double end = getMilliseconds();
+
+        times[run] = mid - start;
+        double ref = end - mid;
+        double diff = fabs(nrm - nrmRef) / (nrmRef > 0.0 ? nrmRef : 1.0);
+        for (idx_t i = 0; i < rows; i++)
+            if (fabs(r[i] - rRef[i]) > diff) diff = fabs(r[i] - rRef[i]);
+        if (diff > maxDiff) maxDiff = diff;
+
+        printf("Run %d: %.6f ms   (unfused: %.6f ms)\n", run + 1, times[run], ref);
+        fflush(stdout);
+        if (run == 0 || times[run] < best) best = times[run];
+        if (run == 0 || ref < bestRef) bestRef = ref;
+    }
+
+    printf("\nFused best: %.6f ms, unfused best: %.6f ms (speedup %.3f), max difference %.3e\n",
+           best, bestRef, bestRef / best, maxDiff);
+    fflush(stdout);
+
+    free(x); free(b); free(r); free(rRef); free(slots);
+    return 1;
+}
+
+// ---------- Matrix powers kernel [A x, A^2 x, ..., A^s x] ----------
+// Rows are cut into contiguous blocks. For each block we collect the
+// dependency closure L_s ⊂ L_{s-1} ⊂ ... ⊂ L_0: L_s are the block's own rows
+// and L_{k-1} = L_k ∪ cols(L_k). Step k computes the block's copy of A^k x on
+// L_k (rows outside the block are recomputed redundantly), so the block's
+// rows are read s times from cache instead of s times from memory.
+// Local indices are ordered by level, which turns every L_k into a prefix.
+#define MPK_CACHE_BYTES (256 * 1024) // per-block working set for the automatic block size
+
+typedef struct {
+    idx_t *len;    // len[k] = |L_k|, k = 0..s; len[s] is the number of own rows
+    idx_t *gid;    // local -> global index, len[0] entries
+    nnz_t *rowPtr; // local CSR over the first len[1] rows
+    idx_t *col;    // local column indices
+    double *val;
+} MPKBlock;
+
+typedef struct {
+    int s;
+    idx_t nblocks;
+    MPKBlock *blocks;
+    idx_t maxLocal;    // largest len[0], sizes the per-thread scratch vectors
+    double buildMs;
+} MPKPlan;
+
+// Builds the per-block closures in parallel; mark/local are per-thread
+// arrays over all rows, reset after each block.
+int buildMPK(idx_t n, double *values, idx_t *colIndex, nnz_t *rowPtr, int s,
+             idx_t blockRows, MPKPlan *plan) {
+    double start = getMilliseconds();
+    plan->s = s;
+    plan->nblocks = (n + blockRows - 1) / blockRows;
+    plan->blocks = (MPKBlock *)calloc((size_t)plan->nblocks, sizeof(MPKBlock));
+    plan->maxLocal = 0;
+    if (!plan->blocks) return 0;
+    int ok = 1;
+    idx_t maxLocal = 0;
+
+    #pragma omp parallel reduction(max:maxLocal)
+    {
+        idx_t *level = (idx_t *)malloc((size_t)n * sizeof(idx_t));
+        idx_t *local = (idx_t *)malloc((size_t)n * sizeof(idx_t));
+        idx_t *order = (idx_t *)malloc((size_t)n * sizeof(idx_t));
+        if (!level || !local || !order) {
+            #pragma omp atomic write
+            ok = 0;
+        } else {
+            for (idx_t i = 0; i < n; i++) level[i] = -1;
+        }
+
+        #pragma omp for schedule(dynamic)
+        for (idx_t b = 0; b < plan->nblocks; b++) {
+            if (!level || !local || !order) continue;
+            MPKBlock *blk = &plan->blocks[b];
+            idx_t first = b * blockRows;
+            idx_t last = (first + blockRows < n) ? first + blockRows : n;
+
+            // Breadth-first expansion; vertices are appended in level order
+            idx_t count = 0;
+            for (idx_t i = first; i < last; i++) { level[i] = s; order[count++] = i; }
+            idx_t frontier = 0;
+            blk->len = (idx_t *)malloc(((size_t)s + 1) * sizeof(idx_t));
+            blk->len[s] = count;
+            for (int k = s; k >= 1; k--) {
+                idx_t end = count;
+                for (idx_t f = frontier; f < end; f++) {
+                    idx_t v = order[f];
+                    for (nnz_t j = rowPtr[v]; j < rowPtr[v + 1]; j++) {
+                        idx_t c = colIndex[j];
+                        if (level[c] < 0) { level[c] = k - 1; order[count++] = c; }
+                    }
+                }
+                frontier = end;
+                blk->len[k - 1] = count;
+            }
+
+            idx_t n1 = blk->len[1];
+            nnz_t localNnz = 0;
+            for (idx_t l = 0; l < n1; l++) localNnz += rowPtr[order[l] + 1] - rowPtr[order[l]];
+            blk->gid = (idx_t *)malloc((size_t)count * sizeof(idx_t));
+            blk->rowPtr = (nnz_t *)malloc(((size_t)n1 + 1) * sizeof(nnz_t));
+            blk->col = (idx_t *)malloc((size_t)(localNnz ? localNnz : 1) * sizeof(idx_t));
+            blk->val = (double *)malloc((size_t)(localNnz ? localNnz : 1) * sizeof(double));
+            if (!blk->gid || !blk->rowPtr || !blk->col || !blk->val) {
+                #pragma omp atomic write
+                ok = 0;
+                continue;
+            }
+            for (idx_t l = 0; l < count; l++) { blk->gid[l] = order[l]; local[order[l]] = l; }
+            nnz_t pos = 0;
+            blk->rowPtr[0] = 0;
+            for (idx_t l = 0; l < n1; l++) {
+                idx_t v = order[l];
+                for (nnz_t j = rowPtr[v]; j < rowPtr[v + 1]; j++) {
+                    blk->col[pos] = local[colIndex[j]];
+                    blk->val[pos] = values[j];
+                    pos++;
+                }
+                blk->rowPtr[l + 1] = pos;
+            }
+            for (idx_t l = 0; l < count; l++) level[order[l]] = -1;
+            if (count > maxLocal) maxLocal = count;
+        }
+        free(level); free(local); free(order);
+    }
+
+    plan->maxLocal = maxLocal;
+    plan->buildMs = getMilliseconds() - start;
+    return ok;
+}
+
+void freeMPK(MPKPlan *plan) {
+    if (!plan->blocks) return;
+    for (idx_t b = 0; b < plan->nblocks; b++) {
+        free(plan->blocks[b].len); free(plan->blocks[b].gid);
+        free(plan->blocks[b].rowPtr); free(plan->blocks[b].col); free(plan->blocks[b].val);
+    }
+    free(plan->blocks);
+    plan->blocks = NULL;
+}
+
+// V[(k-1)*n + i] = (A^k x)_i for k = 1..s. Each block owns its rows of every
+// output vector, so no synchronization is needed between blocks.
+void mpkMultiply(idx_t n, const MPKPlan *plan, double *x, double *V) {
+    int s = plan->s;
+    #pragma omp parallel
+    {
+        // (s + 1) local vectors; vector k only uses its first len[k] entries
+        double *v = (double *)malloc(((size_t)s + 1) * plan->maxLocal * sizeof(double));
+        #pragma omp for schedule(dynamic)
+        for (idx_t b = 0; b < plan->nblocks; b++) {
+            const MPKBlock *blk = &plan->blocks[b];
+            for (idx_t l = 0; l < blk->len[0]; l++) v[l] = x[blk->gid[l]];
+            for (int k = 1; k <= s; k++) {
+                const double *vin = v + (size_t)(k - 1) * plan->maxLocal;
+                double *vout = v + (size_t)k * plan->maxLocal;
+                for (idx_t l = 0; l < blk->len[k]; l++) {
+                    double sum = 0.0;
+                    for (nnz_t j = blk->rowPtr[l]; j < blk->rowPtr[l + 1]; j++)
+                        sum += blk->val[j] * vin[blk->col[j]];
+                    vout[l] = sum;
+                }
+                double *out = V + (size_t)(k - 1) * n;
+                for (idx_t l = 0; l < blk->len[s]; l++) out[blk->gid[l]] = vout[l];
+            }
+        }
+        free(v);
+    }
+}
+
+// Times the matrix powers kernel against s calls of csrMatVecMultiply.
+int benchmarkMPK(idx_t rows, idx_t cols, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                 int s, idx_t blockRows, int runs, double *times) {
+    if (rows != cols) {
+        printf("Error: -op mpk needs a square matrix.\n");
+        fflush(stdout);
+        return 0;
+    }
+    nnz_t nnz = rowPtr[rows];
+    if (blockRows <= 0) {
+        // Own rows plus their s-step halo should stay within MPK_CACHE_BYTES;
+        // assume the halo roughly doubles the block.
+        double rowBytes = (double)nnz / rows * (sizeof(double) + sizeof(idx_t))
+                          + sizeof(nnz_t) + sizeof(idx_t) + sizeof(double) * (s + 1);
+        blockRows = (idx_t)(MPK_CACHE_BYTES / (2.0 * rowBytes));
+        if (blockRows < 1) blockRows = 1;
+    }
+    if (blockRows > rows) blockRows = rows;
+
+    MPKPlan plan = {0};
+    if (!buildMPK(rows, values, colIndex, rowPtr, s, blockRows, &plan)) {
+        printf("Error: memory allocation failed while building the matrix powers plan.\n");
+        fflush(stdout);
+        return 0;
+    }
+
+    // Matrix bytes streamed: every block's local CSR once, versus the full CSR s times
+    double mpkBytes = 0.0, redundant = 0.0;
+    for (idx_t b = 0; b < plan.nblocks; b++) {
+        const MPKBlock *blk = &plan.blocks[b];
+        mpkBytes += (double)blk->rowPtr[blk->len[1]] * (sizeof(double) + sizeof(idx_t))
+                    + (double)(blk->len[1] + 1) * sizeof(nnz_t) + (double)blk->len[0] * sizeof(idx_t);
+        for (int k = 1; k <= s; k++) redundant += blk->rowPtr[blk->len[k]];
+    }
+    double spmvBytes = (double)nnz * (sizeof(double) + sizeof(idx_t)) + (double)(rows + 1) * sizeof(nnz_t);
+    printf("Matrix powers: s=%d, " IDX_FMT " blocks of " IDX_FMT " rows, largest closure " IDX_FMT " rows, build %.6f ms\n",
+           s, plan.nblocks, blockRows, plan.maxLocal, plan.buildMs);
+    printf("Matrix bytes read: %.0f (MPK) vs %.0f (%d x SpMV), ratio %.3f\n",
+           mpkBytes, s * spmvBytes, s, mpkBytes / (s * spmvBytes));
+    printf("Flops vs %d x SpMV (redundant halo rows): %.3f\n", s, redundant / ((double)s * nnz));
+
+    double *x = (double *)malloc((size_t)rows * sizeof(double));
+    double *V = (double *)malloc((size_t)s * rows * sizeof(double));
+    double *W = (double *)malloc((size_t)(s + 1) * rows * sizeof(double));
+    if (!x || !V || !W) {
+        printf("Error: memory allocation failed for matrix powers vectors.\n");
+        fflush(stdout);
+        return 0;
+    }
+
+    printf("\nRunning %d matrix powers kernels (parallel)...\n", runs);
+    fflush(stdout);
+    double best = 0.0, bestRef = 0.0, maxDiff = 0.0;
+    for (int run = 0; run < runs; run++) {
+        for (idx_t i = 0; i < rows; i++) x[i] = W[i] = (double)rand() / RAND_MAX;
+
+        double start = getMilliseconds();
+        mpkMultiply(rows, &plan, x, V);
+        double mid = getMilliseconds();
+        for (int k = 1; k <= s; k++)
+            csrMatVecMultiply(rows, values, colIndex, rowPtr, W + (size_t)(k - 1) * rows, W + (size_t)k * rows);
+        double end = getMilliseconds();
+
+        times[run] = mid - start;
+        double ref = end - mid;
+        for (int k = 1; k <= s; k++) {
+            const double *a = V + (size_t)(k - 1) * rows, *w = W + (size_t)k * rows;
+            double diff = 0.0, norm = 0.0;
+            for (idx_t i = 0; i < rows; i++) {
+                if (fabs(a[i] - w[i]) > diff) diff = fabs(a[i] - w[i]);
+                if (fabs(w[i]) > norm) norm = fabs(w[i]);
+            }
+            if (norm > 0.0) diff /= norm;
+            if (diff > maxDiff) maxDiff = diff;
+        }
+
+        printf("Run %d: %.6f ms   (%d x SpMV: %.6f ms)\n", run + 1, times[run], s, ref);
+        fflush(stdout);
+        if (run == 0 || times[run] < best) best = times[run];
+        if (run == 0 || ref < bestRef) bestRef = ref;
+    }
+
+    printf("\nMPK best: %.6f ms, %d x SpMV best: %.6f ms (speedup %.3f), max rel. difference %.3e\n",
+           best, s, bestRef, bestRef / best, maxDiff);
+    fflush(stdout);
+
+    freeMPK(&plan);
+    free(x); free(V); free(W);
+    return 1;
+}
+
+// ---------- Chebyshev polynomial filter ----------
+// y = T_m((A - c I) / e) x with c, e the centre and half-width of [lmin, lmax],
+// by the three-term recurrence v_k = 2/e (A v_{k-1} - c v_{k-1}) - v_{k-2}.
+// The whole recurrence runs in one parallel region. The vector update is part
+// of the row loop: v_k[i] only needs v_{k-2}[i], so it overwrites v_{k-2} in
+// place and the two buffers swap roles each step without copies. The implicit
+// barrier of each omp for is the only synchronization per step.
+// Returns the buffer (y or w) that holds the result.
+double *chebFilter(idx_t rows, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                   int m, double lmin, double lmax, double *x, double *y, double *w) {
+    double e = (lmax - lmin) / 2.0, c = (lmax + lmin) / 2.0;
+    double *result = (m == 1) ? y : ((m % 2 == 0) ? w : y);
+
+    #pragma omp parallel
+    {
+        // v_1 = (A x - c x) / e
+        #pragma omp for schedule(runtime)
+        for (idx_t i = 0; i < rows; i++) {
+            double sum = 0.0;
+            for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+                sum += values[j] * x[colIndex[j]];
+            y[i] = (sum - c * x[i]) / e;
+        }
+
+        // Private copies of the buffer roles, swapped identically by every thread
+        double *cur = y, *next = w;
+        const double *prev = x;
+        for (int k = 2; k <= m; k++) {
+            #pragma omp for schedule(runtime)
+            for (idx_t i = 0; i < rows; i++) {
+                double sum = 0.0;
+                for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+                    sum += values[j] * cur[colIndex[j]];
+                next[i] = 2.0 / e * (sum - c * cur[i]) - prev[i];
+            }
+            double *t = cur;
+            cur = next;
+            next = t;
+            prev = next; // v_{k-1}, overwritten by v_{k+1} in the next step
+        }
+    }
+    return result;
+}
+
+// Gershgorin interval [min(a_ii - R_i), max(a_ii + R_i)], used when -lmin/-lmax are not given
+void gershgorinBounds(idx_t rows, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                      double *lmin, double *lmax) {
+    double lo = 0.0, hi = 0.0;
+    for (idx_t i = 0; i < rows; i++) {
+        double diag = 0.0, radius = 0.0;
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++) {
+            if (colIndex[j] == i) diag += values[j];
+            else radius += fabs(values[j]);
+        }
+        if (i == 0 || diag - radius < lo) lo = diag - radius;
+        if (i == 0 || diag + radius > hi) hi = diag + radius;
+    }
+    *lmin = lo;
+    *lmax = hi;
+}
+
+// Times chebFilter against m calls of csrMatVecMultiply plus separate update loops.
+int benchmarkCheb(idx_t rows, idx_t cols, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                  int m, double lmin, double lmax, int runs, double *times) {
+    if (rows != cols) {
+        printf("Error: -op cheb needs a square matrix.\n");
+        fflush(stdout);
+        return 0;
+    }
+    if (isnan(lmin) || isnan(lmax)) {
+        double glo, ghi;
+        gershgorinBounds(rows, values, colIndex, rowPtr, &glo, &ghi);
+        if (isnan(lmin)) lmin = glo;
+        if (isnan(lmax)) lmax = ghi;
+    }
+    if (!(lmax > lmin)) {
+        printf("Error: spectral bounds need lmin < lmax (got %g, %g).\n", lmin, lmax);
+        fflush(stdout);
+        return 0;
+    }
+    printf("Chebyshev filter: degree %d on [%g, %g]\n", m, lmin, lmax);
+
+    double *x = (double *)malloc((size_t)rows * sizeof(double));
+    double *y = (double *)malloc((size_t)rows * sizeof(double));
+    double *w = (double *)malloc((size_t)rows * sizeof(double));
+    double *r0 = (double *)malloc((size_t)rows * sizeof(double));
+    double *r1 = (double *)malloc((size_t)rows * sizeof(double));
+    double *r2 = (double *)malloc((size_t)rows * sizeof(double));
+    double *t = (double *)malloc((size_t)rows * sizeof(double));
+    if (!x || !y || !w || !r0 || !r1 || !r2 || !t) {
+        printf("Error: memory allocation failed for Chebyshev vectors.\n");
+        fflush(stdout);
+        return 0;
+    }
+    double e = (lmax - lmin) / 2.0, c = (lmax + lmin) / 2.0;
+
+    printf("\nRunning %d Chebyshev filters (parallel)...\n", runs);
+    fflush(stdout);
+    double best = 0.0, bestRef = 0.0, maxDiff = 0.0;
+    for (int run = 0; run < runs; run++) {
+        for (idx_t i = 0; i < rows; i++) x[i] = (double)rand() / RAND_MAX;
+
+        double start = getMilliseconds();
+        double *res = chebFilter(rows, values, colIndex, rowPtr, m, lmin, lmax, x, y, w);
+        double mid = getMilliseconds();
+
+        // Unfused: SpMV, then the update as its own loop, rotating three vectors
+        double *prev = r0, *cur = r1, *next = r2;
+        for (idx_t i = 0; i < rows; i++) prev[i] = x[i];
+        csrMatVecMultiply(rows, values, colIndex, rowPtr, prev, t);
+        #pragma omp parallel for schedule(static)
+        for (idx_t i = 0; i < rows; i++) cur[i] = (t[i] - c * prev[i]) / e;
+        for (int k = 2; k <= m; k++) {
+            csrMatVecMultiply(rows, values, colIndex, rowPtr, cur, t);
+            #pragma omp parallel for schedule(static)
+            for (idx_t i = 0; i < rows; i++) next[i] = 2.0 / e * (t[i] - c * cur[i]) - prev[i];
+            double *tmp = prev;
+            prev = cur;
+            cur = next;
+            next = tmp;
+        }
+        double end = getMilliseconds();
+
+        times[run] = mid - start;
+        double ref = end - mid;
+        double diff = 0.0, norm = 0.0;
+        for (idx_t i = 0; i < rows; i++) {
+            if (fabs(res[i] - cur[i]) > diff) diff = fabs(res[i] - cur[i]);
+            if (fabs(cur[i]) > norm) norm = fabs(cur[i]);
+        }
+        if (norm > 0.0) diff /= norm;
+        if (diff > maxDiff) maxDiff = diff;
+
+        printf("Run %d: %.6f ms   (unfused: %.6f ms)\n", run + 1, times[run], ref);
+        fflush(stdout);
+        if (run == 0 || times[run] < best) best = times[run];
+        if (run == 0 || ref < bestRef) bestRef = ref;
+    }
+
+    printf("\nFused best: %.6f ms (%.6f ms per degree), unfused best: %.6f ms (speedup %.3f), "
+           "max rel. difference %.3e\n", best, best / m, bestRef, bestRef / best, maxDiff);
+    fflush(stdout);
+
+    free(x); free(y); free(w); free(r0); free(r1); free(r2); free(t);
+    return 1;
+}
+
+// ---------- Eigenvalue modes (-eig power | lanczos) ----------
+#define ORTH_BLOCK 512 // rows per block in the reorthogonalization sweeps
+
+enum { EIG_POWER, EIG_LANCZOS };
+
+int cmpDouble(const void *a, const void *b) {
+    double da = *(const double *)a, db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+// Eigenvalues of the symmetric tridiagonal matrix with diagonal d[0..n-1] and
+// off-diagonal e[0..n-2] by implicit QL; d is overwritten in ascending order
+// and e is destroyed. Returns 0 if an eigenvalue did not converge.
+int tridiagEigenvalues(double *d, double *e, int n) {
+    if (n > 0) e[n - 1] = 0.0;
+    for (int l = 0; l < n; l++) {
+        int iter = 0, m;
+        do {
+            for (m = l; m < n - 1; m++) {
+                double dd = fabs(d[m]) + fabs(d[m + 1]);
+                if (fabs(e[m]) <= 1e-15 * dd) break;
+            }
+            if (m != l) {
+                if (iter++ == 60) return 0;
+                double g = (d[l + 1] - d[l]) / (2.0 * e[l]);
+                double r = hypot(g, 1.0);
+                g = d[m] - d[l] + e[l] / (g + copysign(r, g));
+                double s = 1.0, c = 1.0, p = 0.0;
+                int i;
+                for (i = m - 1; i >= l; i--) {
+                    double f = s * e[i], b = c * e[i];
+                    e[i + 1] = r = hypot(f, g);
+                    if (r == 0.0) {
+                        d[i + 1] -= p;
+                        e[m] = 0.0;
+                        break;
+                    }
+                    s = f / r;
+                    c = g / r;
+                    g = d[i + 1] - p;
+                    r = (d[i] - g) * s + 2.0 * c * b;
+                    p = s * r;
+                    d[i + 1] = g + p;
+                    g = c * r - b;
+                }
+                if (r == 0.0 && i >= l) continue;
+                d[l] -= p;
+                e[l] = g;
+                e[m] = 0.0;
+            }
+        } while (m != l);
+    }
+    qsort(d, (size_t)n, sizeof(double), cmpDouble);
+    return 1;
+}
+
+// One classical Gram-Schmidt pass of w against the k columns of V (n x k,
+// column-major): h = V^T w, then w -= V h, both swept in blocks of ORTH_BLOCK
+// rows so a block of w stays in cache while all k basis vectors pass over it.
+// hPart holds one hStride-sized row of partial sums per thread.
+void cgsPass(idx_t n, const double *V, int k, double *w, double *h,
+             double *hPart, int hStride) {
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num(), nthreads = omp_get_num_threads();
+        double *ht = hPart + (size_t)t * hStride;
+        for (int q = 0; q < k; q++) ht[q] = 0.0;
+
+        #pragma omp for schedule(static)
+        for (idx_t ib = 0; ib < n; ib += ORTH_BLOCK) {
+            idx_t iend = (ib + ORTH_BLOCK < n) ? ib + ORTH_BLOCK : n;
+            for (int q = 0; q < k; q++) {
+                const double *vq = V + (size_t)q * n;
+                double sum = 0.0;
+                for (idx_t i = ib; i < iend; i++) sum += vq[i] * w[i];
+                ht[q] += sum;
+            }
+        }
+
+        #pragma omp for schedule(static)
+        for (int q = 0; q < k; q++) {
+            double sum = 0.0;
+            for (int u = 0; u < nthreads; u++) sum += hPart[(size_t)u * hStride + q];
+            h[q] = sum;
+        }
+
+        #pragma omp for schedule(static)
+        for (idx_t ib = 0; ib < n; ib += ORTH_BLOCK) {
+            idx_t iend = (ib + ORTH_BLOCK < n) ? ib + ORTH_BLOCK : n;
+            for (int q = 0; q < k; q++) {
+                const double *vq = V + (size_t)q * n;
+                double hq = h[q];
+                for (idx_t i = ib; i < iend; i++) w[i] -= hq * vq[i];
+            }
+        }
+    }
+}
+
+double parallelNorm(idx_t n, const double *v) {
+    double sum = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:sum)
+    for (idx_t i = 0; i < n; i++) sum += v[i] * v[i];
+    return sqrt(sum);
+}
+
+void parallelScale(idx_t n, const double *v, double a, double *out) {
+    #pragma omp parallel for schedule(static)
+    for (idx_t i = 0; i < n; i++) out[i] = a * v[i];
+}
+
+// Lanczos with full reorthogonalization (CGS2) for up to m steps from a random
+// start vector. alpha/beta receive the tridiagonal matrix. Returns the number
+// of steps taken (fewer than m if an invariant subspace is found).
+int lanczos(int prec, idx_t n, double *values, float *valuesF, uint16_t *valuesH,
+            idx_t *colIndex, nnz_t *rowPtr, int m, double *alpha, double *beta,
+            double *V, double *w, double *h, double *hPart, int hStride,
+            double *spmvMs, double *orthMs) {
+    for (idx_t i = 0; i < n; i++) w[i] = (double)rand() / RAND_MAX - 0.5;
+    parallelScale(n, w, 1.0 / parallelNorm(n, w), V);
+    *spmvMs = *orthMs = 0.0;
+
+    int steps = 0;
+    for (int j = 0; j < m; j++) {
+        double t0 = getMilliseconds();
+        csrMatVecMultiplyPrec(prec, n, values, valuesF, valuesH, colIndex, rowPtr, V + (size_t)j * n, w);
+        double t1 = getMilliseconds();
+
+        // Two passes make the basis orthogonal to working precision; alpha_j is
+        // the total projection onto v_j.
+        cgsPass(n, V, j + 1, w, h, hPart, hStride);
+        alpha[j] = h[j];
+        cgsPass(n, V, j + 1, w, h, hPart, hStride);
+        alpha[j] += h[j];
+        beta[j] = parallelNorm(n, w);
+        double t2 = getMilliseconds();
+        *spmvMs += t1 - t0;
+        *orthMs += t2 - t1;
+        steps = j + 1;
+
+        if (beta[j] <= 1e-12 * fabs(alpha[j]) || j + 1 == m) break;
+        parallelScale(n, w, 1.0 / beta[j], V + (size_t)(j + 1) * n);
+    }
+    return steps;
+}
+
+// Power iteration for the eigenvalue of largest magnitude (Rayleigh quotient).
+int powerIteration(int prec, idx_t n, double *values, float *valuesF, uint16_t *valuesH,
+                   idx_t *colIndex, nnz_t *rowPtr, int maxIter, double tol,
+                   double *v, double *w, double *lambda) {
+    for (idx_t i = 0; i < n; i++) w[i] = (double)rand() / RAND_MAX;
+    parallelScale(n, w, 1.0 / parallelNorm(n, w), v);
+    double prev = 0.0;
+    *lambda = 0.0;
+    int it = 0;
+    while (it < maxIter) {
+        csrMatVecMultiplyPrec(prec, n, values, valuesF, valuesH, colIndex, rowPtr, v, w);
+        double vw = 0.0, ww = 0.0;
+        #pragma omp parallel for schedule(static) reduction(+:vw, ww)
+        for (idx_t i = 0; i < n; i++) {
+            vw += v[i] * w[i];
+            ww += w[i] * w[i];
+        }
+        it++;
+        *lambda = vw;
+        if (ww == 0.0) break;
+        parallelScale(n, w, 1.0 / sqrt(ww), v);
+        if (it > 1 && fabs(*lambda - prev) <= tol * fabs(*lambda)) break;
+        prev = *lambda;
+    }
+    return it;
+}
+
+int benchmarkEig(int method, int prec, idx_t n, double *values, float *valuesF, uint16_t *valuesH,
+                 idx_t *colIndex, nnz_t *rowPtr, int maxIter, double tol, int nev,
+                 int runs, double *times) {
+    if (method == EIG_POWER) {
+        double *v = (double *)malloc((size_t)n * sizeof(double));
+        double *w = (double *)malloc((size_t)n * sizeof(double));
+        if (!v || !w) {
+            printf("Error: memory allocation failed for power iteration vectors.\n");
+            fflush(stdout);
+            return 0;
+        }
+        printf("\nRunning %d power iterations (parallel, maxit=%d, tol=%.1e)...\n", runs, maxIter, tol);
+        fflush(stdout);
+        double lambda = 0.0;
+        int it = 0;
+        for (int run = 0; run < runs; run++) {
+            double start = getMilliseconds();
+            it = powerIteration(prec, n, values, valuesF, valuesH, colIndex, rowPtr, maxIter, tol, v, w, &lambda);
+            double end = getMilliseconds();
+            times[run] = end - start;
+            printf("Run %d: %.6f ms   (%d iterations, %.1f iterations/s)\n",
+                   run + 1, times[run], it, it / (times[run] / 1000.0));
+            fflush(stdout);
+        }
+        printf("\nPower iteration: largest |lambda| Rayleigh quotient %.12e after %d iterations%s\n",
+               lambda, it, it == maxIter ? " (not converged)" : "");
+        fflush(stdout);
+        free(v); free(w);
+        return 1;
+    }
+
+    int m = (maxIter < n) ? maxIter : (int)n;
+    int hStride = (m + 7) & ~7; // whole cache lines per thread
+    double *V = (double *)malloc((size_t)n * m * sizeof(double));
+    double *w = (double *)malloc((size_t)n * sizeof(double));
+    double *alpha = (double *)malloc((size_t)m * sizeof(double));
+    double *beta = (double *)malloc((size_t)m * sizeof(double));
+    double *h = (double *)malloc((size_t)m * sizeof(double));
+    double *hPart = (double *)malloc((size_t)omp_get_max_threads() * hStride * sizeof(double));
+    if (!V || !w || !alpha || !beta || !h || !hPart) {
+        printf("Error: memory allocation failed for Lanczos basis (%d vectors).\n", m);
+        fflush(stdout);
+        return 0;
+    }
+
+    printf("\nRunning %d Lanczos runs (parallel, %d steps, full CGS2 reorthogonalization)...\n", runs, m);
+    fflush(stdout);
+    int steps = 0;
+    double spmvMs = 0.0, orthMs = 0.0;
+    for (int run = 0; run < runs; run++) {
+        double start = getMilliseconds();
+        steps = lanczos(prec, n, values, valuesF, valuesH, colIndex, rowPtr, m, alpha, beta,
+                        V, w, h, hPart, hStride, &spmvMs, &orthMs);
+        double end = getMilliseconds();
+        times[run] = end - start;
+        printf("Run %d: %.6f ms   (%d steps, %.1f iterations/s)\n",
+               run + 1, times[run], steps, steps / (times[run] / 1000.0));
+        fflush(stdout);
+    }
+    printf("\nLanczos (last run): SpMV %.6f ms, reorthogonalization %.6f ms\n", spmvMs, orthMs);
+
+    // Ritz values of the last run
+    double *d = (double *)malloc((size_t)steps * sizeof(double));
+    double *e = (double *)malloc((size_t)steps * sizeof(double));
+    for (int j = 0; j < steps; j++) {
+        d[j] = alpha[j];
+        e[j] = beta[j];
+    }
+    if (!tridiagEigenvalues(d, e, steps)) {
+        printf("Warning: QL iteration did not converge for all Ritz values.\n");
+    }
+    int shown = (nev < steps) ? nev : steps;
+    printf("Largest Ritz values: ");
+    for (int j = 0; j < shown; j++) printf("%.12e ", d[steps - 1 - j]);
+    printf("\nSmallest Ritz values:");
+    for (int j = 0; j < shown; j++) printf(" %.12e", d[j]);
+    printf("\n");
+    fflush(stdout);
+
+    free(d); free(e);
+    free(V); free(w); free(alpha); free(beta); free(h); free(hPart);
+    return 1;
+}
+
+// ---------- Column (x) cache blocking ----------
+// The matrix is split into vertical panels of panelWidth columns, each stored
+// as its own CSR over all rows with column offsets relative to the panel.
+// Panels are multiplied one after another against their slice of x, which
+// then stays in the chosen cache level, and accumulate into y. The price is
+// one extra pass over y and rowPtr per panel.
+typedef struct {
+    idx_t panels, panelWidth;
+    nnz_t *rowPtr;   // panels * (rows + 1) entries
+    idx_t *colIndex; // offset within the panel
+    double *values;
+    int level;       // cache level the panel width was sized for, 0 = none
+    long cacheBytes;
+} ColBlocked;
+
+// Data cache size of level 1-3 in bytes: sysconf where glibc provides it, else
+// sysfs, else a conservative guess
+long cacheSize(int level) {
+#if defined(_SC_LEVEL1_DCACHE_SIZE)
+    long v = sysconf(level == 1 ? _SC_LEVEL1_DCACHE_SIZE :
+                     level == 2 ? _SC_LEVEL2_CACHE_SIZE : _SC_LEVEL3_CACHE_SIZE);
+    if (v > 0) return v;
+#endif
+    for (int index = 0; index < 8; index++) {
+        char path[128], type[32] = "";
+        int lvl = 0;
+        long size = 0;
+        char unit = 'B';
+        FILE *f;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", index);
+        if (!(f = fopen(path, "r"))) break;
+        if (fscanf(f, "%d", &lvl) != 1) lvl = 0;
+        fclose(f);
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", index);
+        if ((f = fopen(path, "r"))) {
+            if (fscanf(f, "%31s", type) != 1) type[0] = '\0';
+            fclose(f);
+        }
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index);
+        if ((f = fopen(path, "r"))) {
+            if (fscanf(f, "%ld%c", &size, &unit) < 1) size = 0;
+            fclose(f);
+        }
+        if (lvl == level && strcmp(type, "Instruction") != 0 && size > 0)
+            return size * (unit == 'K' ? 1024L : unit == 'M' ? 1024L * 1024L : 1L);
+    }
+    return level == 1 ? 32L * 1024 : level == 2 ? 1024L * 1024 : 8L * 1024 * 1024;
+}
+
+// Half of the chosen level holds the x slice, the rest is left for the
+// streamed matrix and y. level 0 picks L2, or no blocking when x already fits.
+void buildColBlocked(idx_t rows, idx_t cols, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                     int level, ColBlocked *cb) {
+    if (level == 0) {
+        level = ((double)cols * sizeof(double) <= cacheSize(2) / 2) ? 0 : 2;
+    }
+    cb->level = level;
+    cb->cacheBytes = level ? cacheSize(level) : 0;
+    cb->panelWidth = level ? (idx_t)(cb->cacheBytes / 2 / sizeof(double)) : cols;
+    if (cb->panelWidth < 1) cb->panelWidth = 1;
+    if (cb->panelWidth > cols) cb->panelWidth = cols;
+    cb->panels = (cols + cb->panelWidth - 1) / cb->panelWidth;
+
+    idx_t P = cb->panels;
+    nnz_t nnz = rowPtr[rows];
+    cb->rowPtr = (nnz_t *)malloc((size_t)P * ((size_t)rows + 1) * sizeof(nnz_t));
+    cb->colIndex = (idx_t *)malloc((size_t)(nnz ? nnz : 1) * sizeof(idx_t));
+    cb->values = (double *)malloc((size_t)(nnz ? nnz : 1) * sizeof(double));
+    if (!cb->rowPtr || !cb->colIndex || !cb->values) {
+        printf("Error: memory allocation failed for column panels.\n");
+        fflush(stdout);
+        exit(1);
+    }
+
+    // Row counts per panel; columns are sorted within a row, so each row
+    // contributes a contiguous run to every panel
+    #pragma omp parallel for schedule(runtime)
+    for (idx_t i = 0; i < rows; i++) {
+        for (idx_t p = 0; p < P; p++) cb->rowPtr[(size_t)p * (rows + 1) + i + 1] = 0;
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+            cb->rowPtr[(size_t)(colIndex[j] / cb->panelWidth) * (rows + 1) + i + 1]++;
+    }
+    nnz_t offset = 0;
+    for (idx_t p = 0; p < P; p++) {
+        nnz_t *ptr = cb->rowPtr + (size_t)p * (rows + 1);
+        ptr[0] = offset;
+        for (idx_t i = 0; i < rows; i++) ptr[i + 1] += ptr[i];
+        offset = ptr[rows];
+    }
+    #pragma omp parallel for schedule(runtime)
+    for (idx_t i = 0; i < rows; i++) {
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++) {
+            idx_t p = colIndex[j] / cb->panelWidth;
+            nnz_t *ptr = cb->rowPtr + (size_t)p * (rows + 1);
+            nnz_t dest = ptr[i]++;
+            cb->colIndex[dest] = colIndex[j] - p * cb->panelWidth;
+            cb->values[dest] = values[j];
+        }
+    }
+    // The fill advanced every ptr[i] to the start of row i + 1; shift back
+    for (idx_t p = 0; p < P; p++) {
+        nnz_t *ptr = cb->rowPtr + (size_t)p * (rows + 1);
+        for (idx_t i = rows; i > 0; i--) ptr[i] = ptr[i - 1];
+        ptr[0] = (p == 0) ? 0 : cb->rowPtr[(size_t)(p - 1) * (rows + 1) + rows];
+    }
+}
+
+void freeColBlocked(ColBlocked *cb) {
+    free(cb->rowPtr);
+    free(cb->colIndex);
+    free(cb->values);
+}
+
+void colBlockedMatVec(idx_t rows, const ColBlocked *cb, double *x, double *y) {
+    #pragma omp parallel
+    {
+        for (idx_t p = 0; p < cb->panels; p++) {
+            const nnz_t *ptr = cb->rowPtr + (size_t)p * (rows + 1);
+            const double *xp = x + p * cb->panelWidth;
+            #pragma omp for schedule(runtime)
+            for (idx_t i = 0; i < rows; i++) {
+                double sum = (p == 0) ? 0.0 : y[i];
+                for (nnz_t j = ptr[i]; j < ptr[i + 1]; j++)
+                    sum += cb->values[j] * xp[cb->colIndex[j]];
+                y[i] = sum;
+            }
+        }
+    }
+}
+
+// Times the column-blocked kernel against csrMatVecMultiply.
+int benchmarkColBlocked(idx_t rows, idx_t cols, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                        int level, int runs, double *times) {
+    double start = getMilliseconds();
+    ColBlocked cb;
+    buildColBlocked(rows, cols, values, colIndex, rowPtr, level, &cb);
+    double buildMs = getMilliseconds() - start;
+
+    if (cb.level)
+        printf("Column blocking: L%d (%ld KiB), panel width " IDX_FMT " columns, " IDX_FMT " panel(s)\n",
+               cb.level, cb.cacheBytes / 1024, cb.panelWidth, cb.panels);
+    else
+        printf("Column blocking: none, x (%.0f KiB) fits in half of L2 (%ld KiB), 1 panel\n",
+               (double)cols * sizeof(double) / 1024, cacheSize(2) / 1024);
+    printf("Panel build: %.6f ms\n", buildMs);
+    fflush(stdout);
+
+    double *x = (double *)malloc((size_t)cols * sizeof(double));
+    double *y = (double *)malloc((size_t)rows * sizeof(double));
+    double *yRef = (double *)malloc((size_t)rows * sizeof(double));
+    if (!x || !y || !yRef) {
+        printf("Error: memory allocation failed for blocked vectors.\n");
+        fflush(stdout);
+        return 0;
+    }
+
+    printf("\nRunning %d column-blocked multiplications (parallel)...\n", runs);
+    fflush(stdout);
+    double best = 0.0, bestRef = 0.0, maxDiff = 0.0;
+    for (int run = 0; run < runs; run++) {
+        for (idx_t j = 0; j < cols; j++) x[j] = (double)rand() / RAND_MAX;
+
+        double t0 = getMilliseconds();
+        colBlockedMatVec(rows, &cb, x, y);
+        double t1 = getMilliseconds();
+        csrMatVecMultiply(rows, values, colIndex, rowPtr, x, yRef);
+        double t2 = getMilliseconds();
+
+        times[run] = t1 - t0;
+        double ref = t2 - t1;
+        double diff = 0.0, norm = 0.0;
+        for (idx_t i = 0; i < rows; i++) {
+            if (fabs(y[i] - yRef[i]) > diff) diff = fabs(y[i] - yRef[i]);
+            if (fabs(yRef[i]) > norm) norm = fabs(yRef[i]);
+        }
+        if (norm > 0.0) diff /= norm;
+        if (diff > maxDiff) maxDiff = diff;
+
+        printf("Run %d: %.6f ms   (unblocked: %.6f ms)\n", run + 1, times[run], ref);
+        fflush(stdout);
+        if (run == 0 || times[run] < best) best = times[run];
+        if (run == 0 || ref < bestRef) bestRef = ref;
+    }
+
+    printf("\nBlocked best: %.6f ms, unblocked best: %.6f ms (speedup %.3f), max rel. difference %.3e\n",
+           best, bestRef, bestRef / best, maxDiff);
+    fflush(stdout);
+
+    freeColBlocked(&cb);
+    free(x); free(y); free(yRef);
+    return 1;
+}
+
+// ---------- Dense tiles + CSR remainder ----------
+// Rows are grouped in TILE_R-row blocks and columns in aligned TILE_C-wide
+// strips. Every TILE_R x TILE_C tile holding at least fill * TILE_R * TILE_C
+// nonzeros is stored dense (zeros filled in) and multiplied by a fixed-size
+// micro-kernel; the other nonzeros stay in a CSR remainder.
+#define TILE_R 4
+#define TILE_C 4
+
+typedef struct {
+    idx_t blocks;     // row blocks of TILE_R rows
+    nnz_t *tilePtr;   // tiles of row block b: tilePtr[b] .. tilePtr[b + 1] - 1
+    idx_t *tileCol;   // first column of each tile (a multiple of TILE_C)
+    double *tileVal;  // TILE_R * TILE_C values per tile, row-major
+    nnz_t *rowPtr;    // CSR remainder
+    idx_t *colIndex;
+    double *values;
+    nnz_t tileNnz;    // original nonzeros moved into tiles
+} DenseTiled;
+
+// Counts the nonzeros of every tile of a row block in a per-thread array
+// over the column strips; touched strips are listed so the reset is cheap.
+void buildDenseTiled(idx_t rows, idx_t cols, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                     double fill, DenseTiled *D) {
+    idx_t strips = (cols + TILE_C - 1) / TILE_C;
+    idx_t minNnz = (idx_t)ceil(fill * TILE_R * TILE_C);
+    if (minNnz < 1) minNnz = 1;
+    D->blocks = (rows + TILE_R - 1) / TILE_R;
+    D->tilePtr = (nnz_t *)calloc((size_t)D->blocks + 1, sizeof(nnz_t));
+    D->rowPtr = (nnz_t *)calloc((size_t)rows + 1, sizeof(nnz_t));
+    char *inTile = (char *)calloc((size_t)(rowPtr[rows] ? rowPtr[rows] : 1), 1);
+    if (!D->tilePtr || !D->rowPtr || !inTile) {
+        printf("Error: memory allocation failed for dense tiles.\n");
+        fflush(stdout);
+        exit(1);
+    }
+
+    // Pass 1: mark nonzeros that fall into dense tiles, count tiles per
+    // block and remainder nonzeros per row
+    #pragma omp parallel
+    {
+        idx_t *count = (idx_t *)calloc((size_t)strips, sizeof(idx_t));
+        idx_t *touched = (idx_t *)malloc((size_t)(strips ? strips : 1) * sizeof(idx_t));
+        #pragma omp for schedule(runtime)
+        for (idx_t b = 0; b < D->blocks; b++) {
+            idx_t r0 = b * TILE_R, r1 = (r0 + TILE_R < rows) ? r0 + TILE_R : rows;
+            idx_t ntouched = 0, ntiles = 0;
+            for (nnz_t j = rowPtr[r0]; j < rowPtr[r1]; j++) {
+                idx_t s = colIndex[j] / TILE_C;
+                if (count[s]++ == 0) touched[ntouched++] = s;
+            }
+            for (idx_t t = 0; t < ntouched; t++)
+                if (count[touched[t]] >= minNnz) ntiles++;
+            for (idx_t i = r0; i < r1; i++) {
+                idx_t rest = 0;
+                for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++) {
+                    if (count[colIndex[j] / TILE_C] >= minNnz) inTile[j] = 1;
+                    else rest++;
+                }
+                D->rowPtr[i + 1] = rest;
+            }
+            for (idx_t t = 0; t < ntouched; t++) count[touched[t]] = 0;
+            D->tilePtr[b + 1] = ntiles;
+        }
+        free(count);
+        free(touched);
+    }
+    for (idx_t b = 0; b < D->blocks; b++) D->tilePtr[b + 1] += D->tilePtr[b];
+    for (idx_t i = 0; i < rows; i++) D->rowPtr[i + 1] += D->rowPtr[i];
+
+    nnz_t ntiles = D->tilePtr[D->blocks], rest = D->rowPtr[rows];
+    D->tileNnz = rowPtr[rows] - rest;
+    D->tileCol = (idx_t *)malloc((size_t)(ntiles ? ntiles : 1) * sizeof(idx_t));
+    D->tileVal = (double *)calloc((size_t)(ntiles ? ntiles : 1) * TILE_R * TILE_C, sizeof(double));
+    D->colIndex = (idx_t *)malloc((size_t)(rest ? rest : 1) * sizeof(idx_t));
+    D->values = (double *)malloc((size_t)(rest ? rest : 1) * sizeof(double));
+    if (!D->tileCol || !D->tileVal || !D->colIndex || !D->values) {
+        printf("Error: memory allocation failed for dense tiles.\n");
+        fflush(stdout);
+        exit(1);
+    }
+
+    // Pass 2: fill. Tiles of a block are numbered in the order their first
+    // nonzero is met; tileOf maps a strip to its tile within the block.
+    #pragma omp parallel
+    {
+        nnz_t *tileOf = (nnz_t *)malloc((size_t)(strips ? strips : 1) * sizeof(nnz_t));
+        for (idx_t s = 0; s < strips; s++) tileOf[s] = -1;
+        #pragma omp for schedule(runtime)
+        for (idx_t b = 0; b < D->blocks; b++) {
+            idx_t r0 = b * TILE_R, r1 = (r0 + TILE_R < rows) ? r0 + TILE_R : rows;
+            nnz_t t0 = D->tilePtr[b], nt = 0;
+            for (idx_t i = r0; i < r1; i++) {
+                nnz_t dst = D->rowPtr[i];
+                for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++) {
+                    if (!inTile[j]) {
+                        D->colIndex[dst] = colIndex[j];
+                        D->values[dst++] = values[j];
+                        continue;
+                    }
+                    idx_t s = colIndex[j] / TILE_C;
+                    if (tileOf[s] < 0) {
+                        tileOf[s] = t0 + nt++;
+                        D->tileCol[tileOf[s]] = s * TILE_C;
+                    }
+                    D->tileVal[(size_t)tileOf[s] * TILE_R * TILE_C + (i - r0) * TILE_C + (colIndex[j] - s * TILE_C)] += values[j];
+                }
+            }
+            for (nnz_t t = t0; t < t0 + nt; t++) tileOf[D->tileCol[t] / TILE_C] = -1;
+        }
+        free(tileOf);
+    }
+    free(inTile);
+}
+
+void freeDenseTiled(DenseTiled *D) {
+    free(D->tilePtr); free(D->tileCol); free(D->tileVal);
+    free(D->rowPtr); free(D->colIndex); free(D->values);
+}
+
+// y[0..TILE_R) += T x[c0 .. c0 + TILE_C); fixed trip counts, so the compiler
+// keeps the partial sums in registers and vectorizes across the tile row
+static inline void denseTileGemv(const double *T, const double *x, double *acc) {
+    for (int r = 0; r < TILE_R; r++) {
+        double sum = 0.0;
+        #pragma omp simd reduction(+:sum)
+        for (int c = 0; c < TILE_C; c++) sum += T[r * TILE_C + c] * x[c];
+        acc[r] += sum;
+    }
+}
+
+void denseTiledMatVec(idx_t rows, idx_t cols, const DenseTiled *D, double *x, double *y) {
+    #pragma omp parallel for schedule(runtime)
+    for (idx_t b = 0; b < D->blocks; b++) {
+        idx_t r0 = b * TILE_R, r1 = (r0 + TILE_R < rows) ? r0 + TILE_R : rows;
+        double acc[TILE_R] = {0.0};
+        for (nnz_t t = D->tilePtr[b]; t < D->tilePtr[b + 1]; t++) {
+            idx_t c0 = D->tileCol[t];
+            const double *T = D->tileVal + (size_t)t * TILE_R * TILE_C;
+            if (c0 + TILE_C <= cols) {
+                denseTileGemv(T, x + c0, acc);
+            } else {
+                // Last strip of a matrix whose width is not a multiple of TILE_C
+                for (int r = 0; r < TILE_R; r++)
+                    for (idx_t c = 0; c0 + c < cols; c++) acc[r] += T[r * TILE_C + c] * x[c0 + c];
+            }
+        }
+        for (idx_t i = r0; i < r1; i++) {
+            double sum = acc[i - r0];
+            for (nnz_t j = D->rowPtr[i]; j < D->rowPtr[i + 1]; j++)
+                sum += D->values[j] * x[D->colIndex[j]];
+            y[i] = sum;
+        }
+    }
+}
+
+// Times the dense-tile kernel against csrMatVecMultiply.
+int benchmarkDenseTiled(idx_t rows, idx_t cols, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                        double fill, int runs, double *times) {
+    nnz_t nnz = rowPtr[rows];
+    double start = getMilliseconds();
+    DenseTiled D;
+    buildDenseTiled(rows, cols, values, colIndex, rowPtr, fill, &D);
+    double buildMs = getMilliseconds() - start;
+
+    nnz_t ntiles = D.tilePtr[D.blocks];
+    double csrBytes = (double)nnz * (sizeof(double) + sizeof(idx_t)) + (double)(rows + 1) * sizeof(nnz_t);
+    double tiledBytes = (double)ntiles * (TILE_R * TILE_C * sizeof(double) + sizeof(idx_t))
+                        + (double)(D.blocks + 1) * sizeof(nnz_t)
+                        + (double)(nnz - D.tileNnz) * (sizeof(double) + sizeof(idx_t))
+                        + (double)(rows + 1) * sizeof(nnz_t);
+    printf("Dense tiles (%dx%d, fill >= %.2f): " NNZ_FMT " tiles, analysis %.6f ms\n",
+           TILE_R, TILE_C, fill, ntiles, buildMs);
+    printf("  Nonzeros in tiles: " NNZ_FMT " of " NNZ_FMT " (%.1f%%), explicit zeros stored: %.0f\n",
+           D.tileNnz, nnz, 100.0 * D.tileNnz / (nnz ? nnz : 1),
+           (double)ntiles * TILE_R * TILE_C - D.tileNnz);
+    printf("  Matrix bytes CSR: %.0f  tiles + CSR remainder: %.0f  (ratio %.3f)\n",
+           csrBytes, tiledBytes, csrBytes / tiledBytes);
+    fflush(stdout);
+
+    double *x = (double *)malloc((size_t)cols * sizeof(double));
+    double *y = (double *)malloc((size_t)rows * sizeof(double));
+    double *yRef = (double *)malloc((size_t)rows * sizeof(double));
+    if (!x || !y || !yRef) {
+        printf("Error: memory allocation failed for dense tile vectors.\n");
+        fflush(stdout);
+        return 0;
+    }
+
+    printf("\nRunning %d dense-tile multiplications (parallel)...\n", runs);
+    fflush(stdout);
+    double best = 0.0, bestRef = 0.0, maxDiff = 0.0;
+    for (int run = 0; run < runs; run++) {
+        for (idx_t j = 0; j < cols; j++) x[j] = (double)rand() / RAND_MAX;
+
+        double t0 = getMilliseconds();
+        denseTiledMatVec(rows, cols, &D, x, y);
+        double t1 = getMilliseconds();
+        csrMatVecMultiply(rows, values, colIndex, rowPtr, x, yRef);
+        double t2 = getMilliseconds();
+
+        times[run] = t1 - t0;
+        double ref = t2 - t1;
+        double diff = 0.0, norm = 0.0;
+        for (idx_t i = 0; i < rows; i++) {
+            if (fabs(y[i] - yRef[i]) > diff) diff = fabs(y[i] - yRef[i]);
+            if (fabs(yRef[i]) > norm) norm = fabs(yRef[i]);
+        }
+        if (norm > 0.0) diff /= norm;
+        if (diff > maxDiff) maxDiff = diff;
+
+        printf("Run %d: %.6f ms   (CSR: %.6f ms)\n", run + 1, times[run], ref);
+        fflush(stdout);
+        if (run == 0 || times[run] < best) best = times[run];
+        if (run == 0 || ref < bestRef) bestRef = ref;
+    }
+
+    printf("\nDense tiles best: %.6f ms, CSR best: %.6f ms (speedup %.3f), max rel. difference %.3e\n",
+           best, bestRef, bestRef / best, maxDiff);
+    fflush(stdout);
+
+    freeDenseTiled(&D);
+    free(x); free(y); free(yRef);
+    return 1;
+}
+
+// ---------- Interleaved (AoS) value/index layout ----------
+// Nonzeros are packed in groups of IL_GROUP, one group per cache line: the
+// group's column indices followed by its values (5 + 5 with 32-bit indices,
+// 4 + 4 with 64-bit ones). The kernel then reads one stream per thread
+// instead of two, which matters when the hardware prefetchers run out of
+// streams at high thread counts. Groups run across row boundaries, so no
+// padding is added per row.
+#define IL_GROUP (CACHE_LINE / (sizeof(idx_t) + sizeof(double)))
 
 typedef struct {
-    int row;
-    int col;
-    double val;
-} Triplet;
+    idx_t col[IL_GROUP];
+    double val[IL_GROUP];
+} ILGroup;
 
-// ---------- Quick Sort ----------
-int cmpTriplet(const void *a, const void *b) {
-    const Triplet *ta = (const Triplet *)a;
-    const Triplet *tb = (const Triplet *)b;
-    if (ta->row != tb->row) return ta->row - tb->row;
-    return ta->col - tb->col;
+// Returns the groups aligned to a cache line; *base is what has to be freed
+ILGroup *buildInterleaved(nnz_t nnz, double *values, idx_t *colIndex, void **base) {
+    nnz_t ngroups = (nnz + (nnz_t)IL_GROUP - 1) / (nnz_t)IL_GROUP;
+    *base = calloc((size_t)(ngroups ? ngroups : 1) + 1, sizeof(ILGroup));
+    if (!*base) return NULL;
+    ILGroup *groups = (ILGroup *)(((uintptr_t)*base + CACHE_LINE - 1) & ~(uintptr_t)(CACHE_LINE - 1));
+    #pragma omp parallel for schedule(static)
+    for (nnz_t j = 0; j < nnz; j++) {
+        groups[j / IL_GROUP].col[j % IL_GROUP] = colIndex[j];
+        groups[j / IL_GROUP].val[j % IL_GROUP] = values[j];
+    }
+    return groups;
 }
 
-// ---------- CSR Conversion ----------
-void convertToCSR(Triplet *triplets, int nnz, int rows, int cols,
-                  double **values, int **colIndex, int **rowPtr) {
-    *values = (double *)malloc(nnz * sizeof(double));
-    *colIndex = (int *)malloc(nnz * sizeof(int));
-    *rowPtr = (int *)calloc((rows + 1), sizeof(int));
+void ilMatVecMultiply(idx_t rows, const ILGroup *groups, nnz_t *rowPtr, double *x, double *y) {
+    #pragma omp parallel for schedule(runtime)
+    for (idx_t i = 0; i < rows; i++) {
+        // IL_GROUP is a compile-time constant, so / and % become multiplies
+        double sum = 0.0;
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++) {
+            const ILGroup *g = groups + j / IL_GROUP;
+            idx_t s = (idx_t)(j % IL_GROUP);
+            sum += g->val[s] * x[g->col[s]];
+        }
+        y[i] = sum;
+    }
+}
 
-    if (!(*values) || !(*colIndex) || !(*rowPtr)) {
-        printf("Error: memory allocation failed in CSR conversion.\n");
+// Times the interleaved kernel against csrMatVecMultiply at the configured
+// thread count, then repeats both at 1, 2, 4, ... threads up to it.
+int benchmarkInterleaved(idx_t rows, idx_t cols, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                         int runs, double *times) {
+    void *base;
+    double start = getMilliseconds();
+    ILGroup *groups = buildInterleaved(rowPtr[rows], values, colIndex, &base);
+    double buildMs = getMilliseconds() - start;
+    double *x = (double *)malloc((size_t)cols * sizeof(double));
+    double *y = (double *)malloc((size_t)rows * sizeof(double));
+    double *yRef = (double *)malloc((size_t)rows * sizeof(double));
+    if (!groups || !x || !y || !yRef) {
+        printf("Error: memory allocation failed for the interleaved layout.\n");
+        fflush(stdout);
+        return 0;
+    }
+    printf("Interleaved layout: %d nonzeros per %d-byte group, " NNZ_FMT " groups, build %.6f ms\n",
+           (int)IL_GROUP, (int)sizeof(ILGroup), (rowPtr[rows] + (nnz_t)IL_GROUP - 1) / (nnz_t)IL_GROUP, buildMs);
+
+    printf("\nRunning %d interleaved multiplications (parallel)...\n", runs);
+    fflush(stdout);
+    double best = 0.0, bestRef = 0.0, maxDiff = 0.0;
+    for (int run = 0; run < runs; run++) {
+        for (idx_t j = 0; j < cols; j++) x[j] = (double)rand() / RAND_MAX;
+
+        double t0 = getMilliseconds();
+        ilMatVecMultiply(rows, groups, rowPtr, x, y);
+        double t1 = getMilliseconds();
+        csrMatVecMultiply(rows, values, colIndex, rowPtr, x, yRef);
+        double t2 = getMilliseconds();
+
+        times[run] = t1 - t0;
+        double ref = t2 - t1;
+        for (idx_t i = 0; i < rows; i++)
+            if (fabs(y[i] - yRef[i]) > maxDiff) maxDiff = fabs(y[i] - yRef[i]);
+
+        printf("Run %d: %.6f ms   (CSR: %.6f ms)\n", run + 1, times[run], ref);
+        fflush(stdout);
+        if (run == 0 || times[run] < best) best = times[run];
+        if (run == 0 || ref < bestRef) bestRef = ref;
+    }
+    printf("\nInterleaved best: %.6f ms, CSR best: %.6f ms (speedup %.3f), max abs difference %.3e\n",
+           best, bestRef, bestRef / best, maxDiff);
+
+    // Same comparison over a range of thread counts, best of runs each
+    int maxThreads = omp_get_max_threads();
+    printf("\nThread sweep (best of %d):\n", runs);
+    printf("  %-8s %-14s %-14s %s\n", "Threads", "CSR (ms)", "AoS (ms)", "Speedup");
+    for (int t = 1; ; t = (2 * t < maxThreads) ? 2 * t : maxThreads) {
+        omp_set_num_threads(t);
+        double bestCsr = 0.0, bestIl = 0.0;
+        for (int run = 0; run < runs; run++) {
+            for (idx_t j = 0; j < cols; j++) x[j] = (double)rand() / RAND_MAX;
+            double t0 = getMilliseconds();
+            csrMatVecMultiply(rows, values, colIndex, rowPtr, x, yRef);
+            double t1 = getMilliseconds();
+            ilMatVecMultiply(rows, groups, rowPtr, x, y);
+            double t2 = getMilliseconds();
+            if (run == 0 || t1 - t0 < bestCsr) bestCsr = t1 - t0;
+            if (run == 0 || t2 - t1 < bestIl) bestIl = t2 - t1;
+        }
+        printf("  %-8d %-14.6f %-14.6f %.3f\n", t, bestCsr, bestIl, bestCsr / bestIl);
+        if (t == maxThreads) break;
+    }
+    omp_set_num_threads(maxThreads);
+    fflush(stdout);
+
+    free(base); free(x); free(y); free(yRef);
+    return 1;
+}
+
+// ---------- Software prefetching of the x gathers ----------
+// The hardware prefetchers follow values and colIndex but cannot guess the
+// x[colIndex[j]] addresses. The prefetching kernel reads colIndex[j + d]
+// (already on its way in) and prefetches that x element, d nonzeros ahead
+// of its use; d runs across row boundaries. __builtin_prefetch is a GCC/Clang
+// builtin, other compilers get the plain kernel.
+#if defined(__GNUC__)
+#define PREFETCH_READ(p) __builtin_prefetch((p), 0, 0)
+#else
+#define PREFETCH_READ(p) ((void)(p))
+#endif
+
+#define PF_AUTO (-1) // -pf auto: pick the distance with prefetchSweep
+
+void csrMatVecMultiplyPF(idx_t rows, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                         double *x, double *y, int dist) {
+    nnz_t last = rowPtr[rows] - dist; // no prefetch past the end of colIndex
+    #pragma omp parallel for schedule(runtime)
+    for (idx_t i = 0; i < rows; i++) {
+        double sum = 0.0;
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++) {
+            if (j < last) PREFETCH_READ(&x[colIndex[j + dist]]);
+            sum += values[j] * x[colIndex[j]];
+        }
+        y[i] = sum;
+    }
+}
+
+// Times the plain kernel (d = 0) and a range of distances, best of runs each,
+// and returns the fastest d for this matrix.
+int prefetchSweep(idx_t rows, idx_t cols, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                  double *x, double *y, int runs) {
+    static const int dists[] = {0, 4, 8, 16, 32, 64, 128, 256};
+    int nd = (int)(sizeof(dists) / sizeof(dists[0]));
+    int bestDist = 0;
+    double bestTime = 0.0, plain = 0.0;
+    printf("Prefetch distance sweep (best of %d):\n", runs);
+    for (int k = 0; k < nd; k++) {
+        double best = 0.0;
+        for (int run = 0; run < runs; run++) {
+            for (idx_t j = 0; j < cols; j++) x[j] = (double)rand() / RAND_MAX;
+            double start = getMilliseconds();
+            if (dists[k] == 0) csrMatVecMultiply(rows, values, colIndex, rowPtr, x, y);
+            else csrMatVecMultiplyPF(rows, values, colIndex, rowPtr, x, y, dists[k]);
+            double t = getMilliseconds() - start;
+            if (run == 0 || t < best) best = t;
+        }
+        if (k == 0) plain = best;
+        printf("  d = %-4d %.6f ms  (speedup %.2fx)\n", dists[k], best, plain / best);
+        if (k == 0 || best < bestTime) {
+            bestTime = best;
+            bestDist = dists[k];
+        }
+    }
+    printf("Chosen prefetch distance: %d\n", bestDist);
+    fflush(stdout);
+    return bestDist;
+}
+
+// ---------- Non-temporal stores for y ----------
+// y[i] = sum normally reads each y line into cache before writing it, and the
+// written lines then push x lines out. The streaming kernel works on whole
+// cache lines of y: each thread fills a line-sized buffer with 8 row sums and
+// writes it with non-temporal stores, which bypass the cache. The rows before
+// the first 64-byte boundary of y and after the last one use ordinary stores.
+// Without SSE2 the lines are written with ordinary stores.
+#define Y_LINE ((idx_t)(CACHE_LINE / sizeof(double)))
+
+static inline void streamLine(double *dst, const double *buf) {
+#if HAVE_STREAM_STORES
+    for (int k = 0; k < Y_LINE; k += 2)
+        _mm_stream_pd(dst + k, _mm_loadu_pd(buf + k));
+#else
+    memcpy(dst, buf, CACHE_LINE);
+#endif
+}
+
+static inline double csrRowSum(idx_t i, double *values, idx_t *colIndex, nnz_t *rowPtr, double *x) {
+    double sum = 0.0;
+    for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+        sum += values[j] * x[colIndex[j]];
+    return sum;
+}
+
+void csrMatVecMultiplyNT(idx_t rows, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                         double *x, double *y) {
+    idx_t head = (idx_t)(((CACHE_LINE - (uintptr_t)y % CACHE_LINE) % CACHE_LINE) / sizeof(double));
+    if (head > rows) head = rows;
+    idx_t lines = (rows - head) / Y_LINE;
+    idx_t tail = head + lines * Y_LINE;
+
+    #pragma omp parallel
+    {
+        double buf[CACHE_LINE / sizeof(double)];
+        #pragma omp for schedule(runtime) nowait
+        for (idx_t l = 0; l < lines; l++) {
+            idx_t first = head + l * Y_LINE;
+            for (idx_t r = 0; r < Y_LINE; r++)
+                buf[r] = csrRowSum(first + r, values, colIndex, rowPtr, x);
+            streamLine(&y[first], buf);
+        }
+        #pragma omp single nowait
+        {
+            for (idx_t i = 0; i < head; i++) y[i] = csrRowSum(i, values, colIndex, rowPtr, x);
+            for (idx_t i = tail; i < rows; i++) y[i] = csrRowSum(i, values, colIndex, rowPtr, x);
+        }
+#if HAVE_STREAM_STORES
+        _mm_sfence(); // streamed lines are visible to the other threads after the barrier
+#endif
+    }
+}
+
+// ---------- Matrix reordering (-reorder rcm | gorder) ----------
+// The permutation perm maps new indices to old ones: new row i is old row
+// perm[i], and the same permutation is applied to the columns (B = P A P^T),
+// so x and y only need to be permuted when they enter and leave the kernels.
+enum { REORDER_NONE, REORDER_RCM, REORDER_GORDER };
+
+// Pattern of A + A^T without the diagonal, the graph the orderings work on.
+// Each edge appears once per row, so a vertex has at most n - 1 neighbours.
+void symmetricPattern(idx_t n, idx_t *colIndex, nnz_t *rowPtr, nnz_t **gPtr, idx_t **gIdx) {
+    nnz_t *ptr = (nnz_t *)calloc((size_t)n + 1, sizeof(nnz_t));
+    if (!ptr) {
+        printf("Error: memory allocation failed for the symmetric pattern.\n");
+        fflush(stdout);
+        exit(1);
+    }
+    for (idx_t i = 0; i < n; i++)
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+            if (colIndex[j] != i) {
+                ptr[i + 1]++;
+                ptr[colIndex[j] + 1]++;
+            }
+    for (idx_t i = 0; i < n; i++) ptr[i + 1] += ptr[i];
+    idx_t *idx = (idx_t *)malloc((size_t)(ptr[n] ? ptr[n] : 1) * sizeof(idx_t));
+    nnz_t *fill = (nnz_t *)malloc((size_t)n * sizeof(nnz_t));
+    if (!idx || !fill) {
+        printf("Error: memory allocation failed for the symmetric pattern.\n");
+        fflush(stdout);
+        exit(1);
+    }
+    memcpy(fill, ptr, (size_t)n * sizeof(nnz_t));
+    for (idx_t i = 0; i < n; i++)
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+            if (colIndex[j] != i) {
+                idx[fill[i]++] = colIndex[j];
+                idx[fill[colIndex[j]]++] = i;
+            }
+    // A general matrix that stores both (i,j) and (j,i) gives the edge twice; keep one
+    nnz_t *mark = fill;
+    for (idx_t i = 0; i < n; i++) mark[i] = -1;
+    nnz_t out = 0, begin = 0;
+    for (idx_t i = 0; i < n; i++) {
+        nnz_t end = ptr[i + 1];
+        for (nnz_t j = begin; j < end; j++)
+            if (mark[idx[j]] != i) {
+                mark[idx[j]] = i;
+                idx[out++] = idx[j];
+            }
+        begin = end;
+        ptr[i + 1] = out;
+    }
+    free(fill);
+    *gPtr = ptr;
+    *gIdx = idx;
+}
+
+typedef struct {
+    idx_t parent; // position of the first placed neighbour in the previous level
+    idx_t degree;
+    idx_t v;
+} RCMKey;
+
+int cmpRCMKey(const void *a, const void *b) {
+    const RCMKey *ka = (const RCMKey *)a, *kb = (const RCMKey *)b;
+    if (ka->parent != kb->parent) return (ka->parent > kb->parent) - (ka->parent < kb->parent);
+    if (ka->degree != kb->degree) return (ka->degree > kb->degree) - (ka->degree < kb->degree);
+    return (ka->v > kb->v) - (ka->v < kb->v);
+}
+
+// Cuthill-McKee order of the component of root, appended to order[*count..].
+// Levels are expanded in parallel: threads claim the unvisited neighbours of
+// the frontier with an atomic swap on pos[], then each claimed vertex looks up
+// its parent, the neighbour placed first in the frontier. Sorting a level by
+// (parent, degree) gives the sequential Cuthill-McKee order, independent of
+// the thread count. Returns the position where the last level starts.
+idx_t cuthillMcKee(const nnz_t *gPtr, const idx_t *gIdx, idx_t root,
+                   idx_t *pos, idx_t *order, idx_t *count, RCMKey *keys) {
+    idx_t begin = *count, end = *count + 1, lastLevel = begin;
+    idx_t next = 0;
+    int done = 0;
+    order[begin] = root;
+    pos[root] = begin;
+
+    #pragma omp parallel
+    {
+        while (1) {
+            #pragma omp for schedule(dynamic, 64)
+            for (idx_t f = begin; f < end; f++) {
+                idx_t v = order[f];
+                for (nnz_t j = gPtr[v]; j < gPtr[v + 1]; j++) {
+                    idx_t c = gIdx[j], old;
+                    #pragma omp atomic read
+                    old = pos[c];
+                    if (old != -1) continue;
+                    #pragma omp atomic capture
+                    { old = pos[c]; pos[c] = -2; }
+                    if (old == -1) {
+                        idx_t slot;
+                        #pragma omp atomic capture
+                        slot = next++;
+                        keys[slot].v = c;
+                    }
+                }
+            }
+
+            #pragma omp for schedule(static)
+            for (idx_t k = 0; k < next; k++) {
+                idx_t c = keys[k].v, parent = end;
+                for (nnz_t j = gPtr[c]; j < gPtr[c + 1]; j++) {
+                    idx_t p = pos[gIdx[j]];
+                    if (p >= begin && p < parent) parent = p;
+                }
+                keys[k].parent = parent;
+                keys[k].degree = (idx_t)(gPtr[c + 1] - gPtr[c]);
+            }
+
+            #pragma omp single
+            {
+                if (next == 0) {
+                    done = 1;
+                } else {
+                    qsort(keys, (size_t)next, sizeof(RCMKey), cmpRCMKey);
+                    for (idx_t k = 0; k < next; k++) {
+                        order[end + k] = keys[k].v;
+                        pos[keys[k].v] = end + k;
+                    }
+                    lastLevel = end;
+                    begin = end;
+                    end += next;
+                    next = 0;
+                }
+            }
+            if (done) break;
+        }
+    }
+    *count = end;
+    return lastLevel;
+}
+
+// Reverse Cuthill-McKee on the pattern of A + A^T. Components are started
+// from their lowest-degree vertex, moved once to the lowest-degree vertex of
+// the last BFS level (one George-Liu step towards a peripheral vertex).
+void rcmOrdering(idx_t n, idx_t *colIndex, nnz_t *rowPtr, idx_t *perm) {
+    nnz_t *gPtr;
+    idx_t *gIdx;
+    symmetricPattern(n, colIndex, rowPtr, &gPtr, &gIdx);
+    idx_t *pos = (idx_t *)malloc((size_t)n * sizeof(idx_t));
+    idx_t *order = (idx_t *)malloc((size_t)n * sizeof(idx_t));
+    idx_t *byDegree = (idx_t *)malloc((size_t)n * sizeof(idx_t));
+    idx_t *degPtr = (idx_t *)calloc((size_t)n + 1, sizeof(idx_t));
+    RCMKey *keys = (RCMKey *)malloc((size_t)n * sizeof(RCMKey));
+    if (!pos || !order || !byDegree || !degPtr || !keys) {
+        printf("Error: memory allocation failed for RCM.\n");
         fflush(stdout);
         exit(1);
     }
 
-    for (int i = 0; i < nnz; i++) {
-        (*rowPtr)[triplets[i].row + 1]++;
+    // Vertices bucketed by degree, so each new component starts at the
+    // lowest-degree unvisited vertex without rescanning
+    for (idx_t i = 0; i < n; i++) degPtr[gPtr[i + 1] - gPtr[i]]++;
+    for (idx_t d = 0, sum = 0; d <= n; d++) { idx_t c = degPtr[d]; degPtr[d] = sum; sum += c; }
+    for (idx_t i = 0; i < n; i++) byDegree[degPtr[gPtr[i + 1] - gPtr[i]]++] = i;
+    for (idx_t i = 0; i < n; i++) pos[i] = -1;
+
+    idx_t count = 0;
+    for (idx_t s = 0; s < n; s++) {
+        idx_t root = byDegree[s];
+        if (pos[root] != -1) continue;
+        if (gPtr[root + 1] == gPtr[root]) {
+            pos[root] = count;
+            order[count++] = root;
+            continue;
+        }
+        idx_t start = count;
+        idx_t last = cuthillMcKee(gPtr, gIdx, root, pos, order, &count, keys);
+        idx_t best = order[last];
+        for (idx_t k = last; k < count; k++)
+            if (gPtr[order[k] + 1] - gPtr[order[k]] < gPtr[best + 1] - gPtr[best]) best = order[k];
+        if (best != root) {
+            for (idx_t k = start; k < count; k++) pos[order[k]] = -1;
+            count = start;
+            cuthillMcKee(gPtr, gIdx, best, pos, order, &count, keys);
+        }
     }
-    for (int i = 0; i < rows; i++) {
-        (*rowPtr)[i + 1] += (*rowPtr)[i];
+    for (idx_t i = 0; i < n; i++) perm[i] = order[n - 1 - i];
+
+    free(gPtr); free(gIdx); free(pos); free(order); free(byDegree); free(degPtr); free(keys);
+}
+
+// Gorder-style greedy ordering on the pattern of A + A^T: the next vertex is
+// the unplaced one with the highest score against the last GORDER_WINDOW
+// placed vertices, where a window vertex adds 1 for an edge and 1 per shared
+// neighbour. Rows that share many columns end up next to each other, so
+// their x gathers hit the same cache lines. Scores only change by +-1 as
+// vertices enter and leave the window, so they are kept in a bucket queue
+// (one linked list per score) with O(1) updates. Neighbours with degree above
+// sqrt(n) are not expanded for shared neighbours, which bounds the cost on
+// matrices with dense rows.
+#define GORDER_WINDOW 5
+
+typedef struct {
+    idx_t *score, *next, *prev, *head;
+    char *placed;
+    idx_t top;
+} GorderQueue;
+
+static void gorderUnlink(GorderQueue *q, idx_t v) {
+    if (q->prev[v] >= 0) q->next[q->prev[v]] = q->next[v];
+    else q->head[q->score[v]] = q->next[v];
+    if (q->next[v] >= 0) q->prev[q->next[v]] = q->prev[v];
+}
+
+static void gorderLink(GorderQueue *q, idx_t v) {
+    idx_t h = q->head[q->score[v]];
+    q->prev[v] = -1;
+    q->next[v] = h;
+    if (h >= 0) q->prev[h] = v;
+    q->head[q->score[v]] = v;
+    if (q->score[v] > q->top) q->top = q->score[v];
+}
+
+static void gorderAdd(GorderQueue *q, idx_t v, idx_t delta) {
+    if (q->placed[v]) return;
+    gorderUnlink(q, v);
+    q->score[v] += delta;
+    gorderLink(q, v);
+}
+
+// Adds delta to the score of every vertex related to v
+static void gorderUpdate(GorderQueue *q, const nnz_t *gPtr, const idx_t *gIdx, idx_t v,
+                         idx_t delta, idx_t hubDegree) {
+    for (nnz_t j = gPtr[v]; j < gPtr[v + 1]; j++) {
+        idx_t u = gIdx[j];
+        gorderAdd(q, u, delta);
+        if (gPtr[u + 1] - gPtr[u] > hubDegree) continue;
+        for (nnz_t k = gPtr[u]; k < gPtr[u + 1]; k++)
+            if (gIdx[k] != v) gorderAdd(q, gIdx[k], delta);
     }
+}
 
-    // We fill from the end of each row bucket, so make a copy of rowPtr to use as write pointers
-    int *writePtr = (int *)malloc((rows + 1) * sizeof(int));
-    if (!writePtr) {
-        printf("Error: memory allocation failed in CSR conversion (writePtr).\n");
+void gorderOrdering(idx_t n, idx_t *colIndex, nnz_t *rowPtr, idx_t *perm) {
+    nnz_t *gPtr;
+    idx_t *gIdx;
+    symmetricPattern(n, colIndex, rowPtr, &gPtr, &gIdx);
+    idx_t maxDeg = 0;
+    for (idx_t i = 0; i < n; i++)
+        if (gPtr[i + 1] - gPtr[i] > maxDeg) maxDeg = (idx_t)(gPtr[i + 1] - gPtr[i]);
+    idx_t hubDegree = (idx_t)sqrt((double)n);
+    // One window vertex adds at most 1 + deg(v) to the score of v: the edge,
+    // plus one per shared neighbour (the pattern has no duplicate edges)
+    idx_t maxScore = (idx_t)GORDER_WINDOW * (maxDeg + 1);
+
+    GorderQueue q;
+    q.score = (idx_t *)calloc((size_t)n, sizeof(idx_t));
+    q.next = (idx_t *)malloc((size_t)n * sizeof(idx_t));
+    q.prev = (idx_t *)malloc((size_t)n * sizeof(idx_t));
+    q.head = (idx_t *)malloc(((size_t)maxScore + 1) * sizeof(idx_t));
+    q.placed = (char *)calloc((size_t)n, 1);
+    idx_t *degPtr = (idx_t *)calloc((size_t)maxDeg + 2, sizeof(idx_t));
+    idx_t *byDegree = (idx_t *)malloc((size_t)n * sizeof(idx_t));
+    if (!q.score || !q.next || !q.prev || !q.head || !q.placed || !degPtr || !byDegree) {
+        printf("Error: memory allocation failed for Gorder.\n");
         fflush(stdout);
         exit(1);
     }
-    for (int i = 0; i <= rows; i++) writePtr[i] = (*rowPtr)[i];
+    for (idx_t s = 0; s <= maxScore; s++) q.head[s] = -1;
+    q.top = 0;
 
-    for (int i = 0; i < nnz; i++) {
-        int row = triplets[i].row;
-        int dest = writePtr[row];
-        (*values)[dest] = triplets[i].val;
-        (*colIndex)[dest] = triplets[i].col;
-        writePtr[row]++;
+    // Linked in ascending degree, so among zero scores the highest degree
+    // vertex is taken first, as Gorder starts from the largest hub
+    for (idx_t i = 0; i < n; i++) degPtr[gPtr[i + 1] - gPtr[i] + 1]++;
+    for (idx_t d = 0; d <= maxDeg; d++) degPtr[d + 1] += degPtr[d];
+    for (idx_t i = 0; i < n; i++) byDegree[degPtr[gPtr[i + 1] - gPtr[i]]++] = i;
+    for (idx_t i = 0; i < n; i++) gorderLink(&q, byDegree[i]);
+
+    for (idx_t i = 0; i < n; i++) {
+        while (q.top > 0 && q.head[q.top] < 0) q.top--;
+        idx_t v = q.head[q.top];
+        gorderUnlink(&q, v);
+        q.placed[v] = 1;
+        perm[i] = v;
+        // The oldest vertex leaves before v enters, so at most GORDER_WINDOW count
+        if (i >= GORDER_WINDOW) gorderUpdate(&q, gPtr, gIdx, perm[i - GORDER_WINDOW], -1, hubDegree);
+        gorderUpdate(&q, gPtr, gIdx, v, 1, hubDegree);
     }
 
-    free(writePtr);
+    free(gPtr); free(gIdx);
+    free(q.score); free(q.next); free(q.prev); free(q.head); free(q.placed);
+    free(degPtr); free(byDegree);
 }
 
-// ---------- Matrix-Vector Multiplication (parallelized with OpenMP) ----------
-void csrMatVecMultiply(int rows, double *values, int *colIndex, int *rowPtr,
-                       double *x, double *y) {
-    // Each row is independent so we parallelize over rows.
+// B = P A P^T in a new CSR; columns stay sorted within each row
+void permuteCSR(idx_t n, double *values, idx_t *colIndex, nnz_t *rowPtr, const idx_t *perm,
+                double **outValues, idx_t **outColIndex, nnz_t **outRowPtr) {
+    nnz_t nnz = rowPtr[n];
+    idx_t *inv = (idx_t *)malloc((size_t)n * sizeof(idx_t));
+    nnz_t *ptr = (nnz_t *)arenaAlloc(((size_t)n + 1) * sizeof(nnz_t));
+    idx_t *col = (idx_t *)arenaAlloc((size_t)(nnz ? nnz : 1) * sizeof(idx_t));
+    double *val = (double *)arenaAlloc((size_t)(nnz ? nnz : 1) * sizeof(double));
+    if (!inv || !ptr || !col || !val) {
+        printf("Error: memory allocation failed for the permuted matrix.\n");
+        fflush(stdout);
+        exit(1);
+    }
+    ptr[0] = 0;
+    for (idx_t i = 0; i < n; i++) {
+        inv[perm[i]] = i;
+        ptr[i + 1] = ptr[i] + rowPtr[perm[i] + 1] - rowPtr[perm[i]];
+    }
+
     #pragma omp parallel for schedule(runtime)
-    for (int i = 0; i < rows; i++) {
-        double sum = 0.0;
-        for (int j = rowPtr[i]; j < rowPtr[i + 1]; j++) {
-            sum += values[j] * x[colIndex[j]];
+    for (idx_t i = 0; i < n; i++) {
+        nnz_t src = rowPtr[perm[i]], len = rowPtr[perm[i] + 1] - src, dst = ptr[i];
+        // Insertion sort by new column; rows are short
+        for (nnz_t k = 0; k < len; k++) {
+            idx_t c = inv[colIndex[src + k]];
+            double v = values[src + k];
+            nnz_t m = k;
+            while (m > 0 && col[dst + m - 1] > c) {
+                col[dst + m] = col[dst + m - 1];
+                val[dst + m] = val[dst + m - 1];
+                m--;
+            }
+            col[dst + m] = c;
+            val[dst + m] = v;
         }
-        y[i] = sum;
     }
+    free(inv);
+    *outValues = val;
+    *outColIndex = col;
+    *outRowPtr = ptr;
 }
 
-// ---------- Time in milliseconds ----------
-double getMilliseconds() {
-    struct timespec ts;
-    timespec_get(&ts, TIME_UTC);  // get current time in UTC
-    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6; // convert to milliseconds
+// Bandwidth max |i - j| and profile sum_i (i - min_j j) of the pattern of
+// A + A^T, so a file holding one triangle is measured the same way before and
+// after P A P^T moves entries across the diagonal
+void bandwidthProfile(idx_t n, idx_t *colIndex, nnz_t *rowPtr, idx_t *bandwidth, double *profile) {
+    nnz_t *gPtr;
+    idx_t *gIdx;
+    symmetricPattern(n, colIndex, rowPtr, &gPtr, &gIdx);
+    idx_t bw = 0;
+    double prof = 0.0;
+    #pragma omp parallel for schedule(static) reduction(max:bw) reduction(+:prof)
+    for (idx_t i = 0; i < n; i++) {
+        idx_t minCol = i;
+        for (nnz_t j = gPtr[i]; j < gPtr[i + 1]; j++) {
+            idx_t d = gIdx[j] > i ? gIdx[j] - i : i - gIdx[j];
+            if (d > bw) bw = d;
+            if (gIdx[j] < minCol) minCol = gIdx[j];
+        }
+        prof += (double)(i - minCol);
+    }
+    free(gPtr); free(gIdx);
+    *bandwidth = bw;
+    *profile = prof;
+}
+
+// Best-of-runs SpMV time; results are not printed as "Run" lines so the
+// experiment scripts only pick up the main benchmark
+double bestSpMVTime(idx_t rows, idx_t cols, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                    double *x, double *y, int runs) {
+    double best = 0.0;
+    for (int run = 0; run < runs; run++) {
+        for (idx_t j = 0; j < cols; j++) x[j] = (double)rand() / RAND_MAX;
+        double start = getMilliseconds();
+        csrMatVecMultiply(rows, values, colIndex, rowPtr, x, y);
+        double t = getMilliseconds() - start;
+        if (run == 0 || t < best) best = t;
+    }
+    return best;
+}
+
+// Computes the ordering, replaces the CSR arrays with B = P A P^T and reports
+// bandwidth, profile and the SpMV speedup. Returns perm (new -> old).
+idx_t *reorderMatrix(int method, idx_t n, double **values, idx_t **colIndex, nnz_t **rowPtr, int runs) {
+    idx_t *perm = (idx_t *)malloc((size_t)n * sizeof(idx_t));
+    double *x = (double *)malloc((size_t)n * sizeof(double));
+    double *y = (double *)malloc((size_t)n * sizeof(double));
+    if (!perm || !x || !y) {
+        printf("Error: memory allocation failed for reordering.\n");
+        fflush(stdout);
+        exit(1);
+    }
+
+    idx_t bwBefore, bwAfter;
+    double profBefore, profAfter;
+    bandwidthProfile(n, *colIndex, *rowPtr, &bwBefore, &profBefore);
+
+    double start = getMilliseconds();
+    if (method == REORDER_GORDER) gorderOrdering(n, *colIndex, *rowPtr, perm);
+    else rcmOrdering(n, *colIndex, *rowPtr, perm);
+    double *newValues;
+    idx_t *newColIndex;
+    nnz_t *newRowPtr;
+    permuteCSR(n, *values, *colIndex, *rowPtr, perm, &newValues, &newColIndex, &newRowPtr);
+    double reorderMs = getMilliseconds() - start;
+
+    bandwidthProfile(n, newColIndex, newRowPtr, &bwAfter, &profAfter);
+    printf("Reordering (%s): %.6f ms\n", method == REORDER_GORDER ? "gorder" : "rcm", reorderMs);
+    printf("  Bandwidth: " IDX_FMT " -> " IDX_FMT ", profile: %.0f -> %.0f\n",
+           bwBefore, bwAfter, profBefore, profAfter);
+    fflush(stdout);
+
+    double before = bestSpMVTime(n, n, *values, *colIndex, *rowPtr, x, y, runs);
+    double after = bestSpMVTime(n, n, newValues, newColIndex, newRowPtr, x, y, runs);
+    printf("  SpMV best of %d: %.6f ms original, %.6f ms reordered (speedup %.3f)\n",
+           runs, before, after, before / after);
+    // SpMVs needed before the time saved pays for the reordering
+    if (after < before)
+        printf("  Break-even: %.0f SpMVs\n", ceil(reorderMs / (before - after)));
+    else
+        printf("  Break-even: never (reordered SpMV is not faster)\n");
+    fflush(stdout);
+
+    arenaFree(*values); arenaFree(*colIndex); arenaFree(*rowPtr);
+    *values = newValues;
+    *colIndex = newColIndex;
+    *rowPtr = newRowPtr;
+    free(x); free(y);
+    return perm;
 }
 
 // ---------- Command-line utilities ----------
 void printUsage(const char *prog) {
-    printf("Usage: %s <matrix_file> [-r runs] [-t threads] [-s schedule] [-c chunk]\n", prog);
+    printf("Usage: %s <matrix_file> [-r runs] [-t threads] [-s schedule] [-c chunk] [-p precision] [-k vectors]\n"
+           "       [-op ax|atx|ata|pair|dot|res|mpk|cheb|cb|dense|il] [-ms steps] [-mb block_rows] [-cl level] [-df fill]\n"
+           "       [-m degree] [-lmin a] [-lmax b] [-tm auto|scatter|csc] [-solve cg | -eig power|lanczos]\n"
+           "       [-maxit n] [-tol t] [-nev n] [-reorder none|rcm|gorder] [-pf d|auto] [-store normal|nt]\n", prog);
     printf("  -r runs      : number of runs (default 10)\n");
     printf("  -t threads   : number of OpenMP threads (default = hardware)\n");
     printf("  -s schedule  : schedule: static | dynamic | guided | auto (default guided)\n");
     printf("  -c chunk     : chunk size for schedule (integer, default 0)\n");
+    printf("  -p precision : value storage: double | float | bf16 (default double)\n");
+    printf("  -k vectors   : multiply a block of k vectors at once (SpMM, double only, default 1)\n");
+    printf("  -op op       : ax = A x (default), atx = A^T x, ata = A^T A x (fused),\n"
+           "                 pair = A x and A^T u in one pass, dot = A x with <x, Ax> and axpy,\n"
+           "                 res = r = b - A x with ||r||^2, mpk = [A x, ..., A^s x],\n"
+           "                 cheb = Chebyshev filter T_m((A - c I) / e) x,\n"
+           "                 cb = A x with x split into cache-sized column panels,\n"
+           "                 dense = A x with dense 4x4 tiles and a CSR remainder,\n"
+           "                 il = A x with indices and values interleaved per cache line\n");
+    printf("  -ms steps    : matrix powers steps s (default 4)\n");
+    printf("  -mb rows     : matrix powers rows per block, 0 = fit a 256 KiB budget (default 0)\n");
+    printf("  -cl level    : column panels sized for cache level 1 | 2 | 3, 0 = auto (default 0)\n");
+    printf("  -df fill     : -op dense, minimum fraction of nonzeros in a dense tile (default 0.75)\n");
+    printf("  -m degree    : Chebyshev filter degree (default 10)\n");
+    printf("  -lmin/-lmax  : Chebyshev interval (default Gershgorin bounds)\n");
+    printf("  -tm method   : A^T x method: auto | scatter | csc (default auto)\n");
+    printf("  -solve cg    : time CG solves of A x = A*1 instead of single products\n"
+           "                 (symmetric files are expanded to the full matrix)\n");
+    printf("  -eig method  : time eigenvalue runs instead of single products: power | lanczos\n"
+           "                 (symmetric files are expanded to the full matrix)\n");
+    printf("  -maxit n     : CG / power iteration limit (default 1000), Lanczos steps (default 100)\n");
+    printf("  -tol t       : CG relative residual / power eigenvalue tolerance (default 1e-8)\n");
+    printf("  -nev n       : Ritz values printed at each end of the spectrum (default 5)\n");
+    printf("  -reorder m   : permute rows and columns before the runs:\n"
+           "                 none | rcm | gorder (default none)\n");
+    printf("  -pf d        : prefetch x d nonzeros ahead in the A x runs; auto = sweep d per matrix\n"
+           "                 (default 0 = off, -p double and -k 1 only)\n");
+    printf("  -store nt    : write y with non-temporal stores in the A x runs (default normal)\n");
     printf("Example: %s matrix.txt -r 20 -t 8 -s guided -c 16\n", prog);
 }
 
@@ -118,6 +2856,24 @@ int main(int argc, char *argv[]) {
     int threads = 0; // 0 means leave to OpenMP default/hardware
     const char *schedStr = "guided";
     int chunk = 0;
+    const char *precStr = "double";
+    int k = 1;
+    const char *opStr = "ax";
+    const char *transStr = "auto";
+    const char *solveStr = NULL;
+    int mpkSteps = 4;
+    int chebDegree = 10;
+    double lmin = NAN, lmax = NAN;
+    idx_t mpkBlock = 0;
+    int cacheLevel = 0; // 0 = choose from the detected cache sizes
+    double denseFill = 0.75;
+    const char *eigStr = NULL;
+    int nev = 5;
+    int maxIter = 0; // 0 = default of the chosen mode
+    double tol = 1e-8;
+    const char *reorderStr = "none";
+    int pfDist = 0;
+    int ntStores = 0;
 
     // Parse optional args
     for (int i = 2; i < argc; i++) {
@@ -132,6 +2888,62 @@ int main(int argc, char *argv[]) {
         } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
             chunk = atoi(argv[++i]);
             if (chunk < 0) chunk = 0;
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            precStr = argv[++i];
+        } else if (strcmp(argv[i], "-op") == 0 && i + 1 < argc) {
+            opStr = argv[++i];
+        } else if (strcmp(argv[i], "-tm") == 0 && i + 1 < argc) {
+            transStr = argv[++i];
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            chebDegree = atoi(argv[++i]);
+            if (chebDegree <= 0) chebDegree = 10;
+        } else if (strcmp(argv[i], "-lmin") == 0 && i + 1 < argc) {
+            lmin = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-lmax") == 0 && i + 1 < argc) {
+            lmax = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-ms") == 0 && i + 1 < argc) {
+            mpkSteps = atoi(argv[++i]);
+            if (mpkSteps <= 0) mpkSteps = 4;
+        } else if (strcmp(argv[i], "-mb") == 0 && i + 1 < argc) {
+            mpkBlock = (idx_t)atoll(argv[++i]);
+            if (mpkBlock < 0) mpkBlock = 0;
+        } else if (strcmp(argv[i], "-cl") == 0 && i + 1 < argc) {
+            cacheLevel = atoi(argv[++i]);
+            if (cacheLevel < 0 || cacheLevel > 3) cacheLevel = 0;
+        } else if (strcmp(argv[i], "-df") == 0 && i + 1 < argc) {
+            denseFill = atof(argv[++i]);
+            if (denseFill <= 0.0 || denseFill > 1.0) denseFill = 0.75;
+        } else if (strcmp(argv[i], "-solve") == 0 && i + 1 < argc) {
+            solveStr = argv[++i];
+        } else if (strcmp(argv[i], "-maxit") == 0 && i + 1 < argc) {
+            maxIter = atoi(argv[++i]);
+            if (maxIter < 0) maxIter = 0;
+        } else if (strcmp(argv[i], "-eig") == 0 && i + 1 < argc) {
+            eigStr = argv[++i];
+        } else if (strcmp(argv[i], "-nev") == 0 && i + 1 < argc) {
+            nev = atoi(argv[++i]);
+            if (nev <= 0) nev = 5;
+        } else if (strcmp(argv[i], "-tol") == 0 && i + 1 < argc) {
+            tol = atof(argv[++i]);
+            if (tol <= 0.0) tol = 1e-8;
+        } else if (strcmp(argv[i], "-pf") == 0 && i + 1 < argc) {
+            i++;
+            pfDist = (strcmp(argv[i], "auto") == 0) ? PF_AUTO : atoi(argv[i]);
+            if (pfDist < PF_AUTO) pfDist = 0;
+        } else if (strcmp(argv[i], "-store") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "nt") == 0) ntStores = 1;
+            else if (strcmp(argv[i], "normal") == 0) ntStores = 0;
+            else {
+                printf("Error: unknown store mode '%s' (normal, nt).\n", argv[i]);
+                fflush(stdout);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-reorder") == 0 && i + 1 < argc) {
+            reorderStr = argv[++i];
+        } else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+            k = atoi(argv[++i]);
+            if (k <= 0) k = 1;
         } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             printUsage(argv[0]);
             return 0;
@@ -159,11 +2971,20 @@ int main(int argc, char *argv[]) {
     printf("Skipping comment lines (starting with %%)...\n");
     fflush(stdout);
 
+    // The %%MatrixMarket banner on the first line says whether only one triangle is stored
     int comment_count = 0;
+    int symmetric = 0;
     int ch;
     while ((ch = fgetc(fin)) != EOF) {
         if (ch == '%') {
-            while ((ch = fgetc(fin)) != EOF && ch != '\n');
+            char banner[128];
+            int len = 0;
+            while ((ch = fgetc(fin)) != EOF && ch != '\n')
+                if (len < (int)sizeof(banner) - 1) banner[len++] = (char)ch;
+            banner[len] = '\0';
+            if (comment_count == 0 && strstr(banner, "MatrixMarket") &&
+                strstr(banner, "symmetric") && !strstr(banner, "skew"))
+                symmetric = 1;
             comment_count++;
         } else {
             ungetc(ch, fin);
@@ -184,8 +3005,8 @@ int main(int argc, char *argv[]) {
     printf("Reading matrix header...\n");
     fflush(stdout);
 
-    int rows, cols, nnz;
-    if (fscanf(fin, "%d %d %d", &rows, &cols, &nnz) != 3) {
+    long long hdrRows, hdrCols, hdrNnz;
+    if (fscanf(fin, "%lld %lld %lld", &hdrRows, &hdrCols, &hdrNnz) != 3) {
         printf("Error: invalid matrix header.\n");
         printf("Expected format: rows cols nnz\n");
         fflush(stdout);
@@ -193,20 +3014,39 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    printf("Matrix dimensions: %d x %d with %d non-zero elements\n", rows, cols, nnz);
+    printf("Matrix dimensions: %lld x %lld with %lld non-zero elements\n", hdrRows, hdrCols, hdrNnz);
     fflush(stdout);
 
-    if (rows <= 0 || cols <= 0 || nnz <= 0) {
+    if (hdrRows <= 0 || hdrCols <= 0 || hdrNnz <= 0) {
         printf("Error: invalid matrix dimensions (must be positive).\n");
         fflush(stdout);
         fclose(fin);
         return 1;
     }
+    if (hdrNnz > NNZ_MAX) {
+        printf("Error: %lld nonzeros do not fit in %d-bit offsets, rebuild with -DMVM_INDEX64.\n",
+               hdrNnz, (int)(8 * sizeof(nnz_t)));
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+    if (hdrRows > IDX_MAX || hdrCols > IDX_MAX) {
+        printf("Error: matrix dimensions do not fit in %d-bit indices, rebuild with -DMVM_COL64.\n",
+               (int)(8 * sizeof(idx_t)));
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+    idx_t rows = (idx_t)hdrRows, cols = (idx_t)hdrCols;
+    nnz_t nnz = (nnz_t)hdrNnz;
+
+    // Room for the mirrored entries when a symmetric file is expanded (arena slices cannot grow)
+    size_t capacity = (size_t)nnz * (((solveStr || eigStr) && symmetric) ? 2 : 1);
 
     printf("Allocating memory for triplets...\n");
     fflush(stdout);
 
-    Triplet *triplets = (Triplet *)malloc(nnz * sizeof(Triplet));
+    Triplet *triplets = (Triplet *)arenaAlloc(capacity * sizeof(Triplet));
     if (!triplets) {
         printf("Error: memory allocation failed for triplets.\n");
         fflush(stdout);
@@ -217,15 +3057,15 @@ int main(int argc, char *argv[]) {
     printf("Reading matrix elements...\n");
     fflush(stdout);
 
-    int maxRow = 0, maxCol = 0;
+    idx_t maxRow = 0, maxCol = 0;
 
-    for (int i = 0; i < nnz; i++) {
-        if (fscanf(fin, "%d %d %lf", &triplets[i].row, &triplets[i].col, &triplets[i].val) != 3) {
-            printf("Error: invalid matrix element at entry %d.\n", i + 1);
+    for (nnz_t i = 0; i < nnz; i++) {
+        if (fscanf(fin, IDX_SCN " " IDX_SCN " %lf", &triplets[i].row, &triplets[i].col, &triplets[i].val) != 3) {
+            printf("Error: invalid matrix element at entry " NNZ_FMT ".\n", i + 1);
             printf("Expected format: row col value\n");
             fflush(stdout);
             fclose(fin);
-            free(triplets);
+            arenaFree(triplets);
             return 1;
         }
         if (triplets[i].row > maxRow) maxRow = triplets[i].row;
@@ -236,22 +3076,22 @@ int main(int argc, char *argv[]) {
     if (maxRow == rows || maxCol == cols) {
         printf("Detected 1-based indexing, converting to 0-based...\n");
         fflush(stdout);
-        for (int i = 0; i < nnz; i++) {
+        for (nnz_t i = 0; i < nnz; i++) {
             triplets[i].row--;
             triplets[i].col--;
         }
     }
 
     // Validate indices
-    for (int i = 0; i < nnz; i++) {
+    for (nnz_t i = 0; i < nnz; i++) {
         if (triplets[i].row < 0 || triplets[i].row >= rows ||
             triplets[i].col < 0 || triplets[i].col >= cols) {
-            printf("Error: invalid indices at entry %d (row=%d, col=%d)\n",
+            printf("Error: invalid indices at entry " NNZ_FMT " (row=" IDX_FMT ", col=" IDX_FMT ")\n",
                    i + 1, triplets[i].row, triplets[i].col);
-            printf("Valid ranges: row [0,%d), col [0,%d)\n", rows, cols);
+            printf("Valid ranges: row [0," IDX_FMT "), col [0," IDX_FMT ")\n", rows, cols);
             fflush(stdout);
             fclose(fin);
-            free(triplets);
+            arenaFree(triplets);
             return 1;
         }
     }
@@ -259,41 +3099,218 @@ int main(int argc, char *argv[]) {
     printf("Matrix data loaded successfully!\n");
     fflush(stdout);
 
+    if (solveStr) {
+        if (strcmp(solveStr, "cg") != 0) {
+            printf("Unknown solver '%s'. Valid: cg\n", solveStr);
+            fflush(stdout);
+            arenaFree(triplets);
+            return 1;
+        }
+        if (rows != cols) {
+            printf("Error: -solve cg needs a square matrix.\n");
+            fflush(stdout);
+            arenaFree(triplets);
+            return 1;
+        }
+        if (!symmetric) {
+            printf("Warning: file is not marked symmetric, CG assumes it is SPD as stored.\n");
+            fflush(stdout);
+        }
+    }
+    int eigMethod = EIG_POWER;
+    if (eigStr) {
+        if (strcmp(eigStr, "power") == 0) eigMethod = EIG_POWER;
+        else if (strcmp(eigStr, "lanczos") == 0) eigMethod = EIG_LANCZOS;
+        else {
+            printf("Unknown eigen method '%s'. Valid: power, lanczos\n", eigStr);
+            fflush(stdout);
+            arenaFree(triplets);
+            return 1;
+        }
+        if (rows != cols || solveStr) {
+            printf("Error: -eig needs a square matrix and cannot be combined with -solve.\n");
+            fflush(stdout);
+            arenaFree(triplets);
+            return 1;
+        }
+        if (eigMethod == EIG_LANCZOS && !symmetric) {
+            printf("Warning: file is not marked symmetric, Lanczos assumes it is symmetric as stored.\n");
+            fflush(stdout);
+        }
+    }
+    if (maxIter == 0) maxIter = (eigStr && eigMethod == EIG_LANCZOS) ? 100 : 1000;
+
+    // CG and the eigen modes need the whole matrix; the file only holds the
+    // lower triangle, so mirror it
+    if ((solveStr || eigStr) && symmetric) {
+        nnz_t offDiag = 0;
+        for (nnz_t i = 0; i < nnz; i++)
+            if (triplets[i].row != triplets[i].col) offDiag++;
+        if ((long long)nnz + offDiag > NNZ_MAX) {
+            printf("Error: expanded symmetric matrix does not fit in %d-bit offsets, rebuild with -DMVM_INDEX64.\n",
+                   (int)(8 * sizeof(nnz_t)));
+            fflush(stdout);
+            arenaFree(triplets);
+            return 1;
+        }
+        // The triplet array was allocated with room for 2 nnz entries
+        nnz_t next = nnz;
+        for (nnz_t i = 0; i < nnz; i++) {
+            if (triplets[i].row != triplets[i].col) {
+                triplets[next].row = triplets[i].col;
+                triplets[next].col = triplets[i].row;
+                triplets[next].val = triplets[i].val;
+                next++;
+            }
+        }
+        printf("Expanded symmetric storage: " NNZ_FMT " -> " NNZ_FMT " non-zero elements\n", nnz, next);
+        fflush(stdout);
+        nnz = next;
+    }
+
     printf("Sorting triplets using qsort...\n");
     fflush(stdout);
-    qsort(triplets, nnz, sizeof(Triplet), cmpTriplet);
+    qsort(triplets, (size_t)nnz, sizeof(Triplet), cmpTriplet);
 
     printf("Converting to CSR format...\n");
     fflush(stdout);
     double *values;
-    int *colIndex, *rowPtr;
+    idx_t *colIndex;
+    nnz_t *rowPtr;
     convertToCSR(triplets, nnz, rows, cols, &values, &colIndex, &rowPtr);
 
+    int reorder;
+    if (strcmp(reorderStr, "none") == 0) reorder = REORDER_NONE;
+    else if (strcmp(reorderStr, "rcm") == 0) reorder = REORDER_RCM;
+    else if (strcmp(reorderStr, "gorder") == 0) reorder = REORDER_GORDER;
+    else {
+        printf("Unknown reordering '%s'. Valid: none, rcm, gorder\n", reorderStr);
+        fflush(stdout);
+        return 1;
+    }
+    int prec;
+    if (strcmp(precStr, "double") == 0) prec = PREC_DOUBLE;
+    else if (strcmp(precStr, "float") == 0) prec = PREC_FLOAT;
+    else if (strcmp(precStr, "bf16") == 0) prec = PREC_BF16;
+    else {
+        printf("Unknown precision '%s'. Valid: double, float, bf16\n", precStr);
+        fflush(stdout);
+        return 1;
+    }
+    if (k > 1 && prec != PREC_DOUBLE) {
+        printf("Error: -k is only implemented for -p double.\n");
+        fflush(stdout);
+        return 1;
+    }
+
+    int transMethod;
+    if (strcmp(transStr, "auto") == 0) transMethod = TRANS_AUTO;
+    else if (strcmp(transStr, "scatter") == 0) transMethod = TRANS_SCATTER;
+    else if (strcmp(transStr, "csc") == 0) transMethod = TRANS_CSC;
+    else {
+        printf("Unknown transpose method '%s'. Valid: auto, scatter, csc\n", transStr);
+        fflush(stdout);
+        return 1;
+    }
+    if (strcmp(opStr, "ax") != 0 && strcmp(opStr, "atx") != 0 &&
+        strcmp(opStr, "ata") != 0 && strcmp(opStr, "pair") != 0 &&
+        strcmp(opStr, "dot") != 0 && strcmp(opStr, "res") != 0 &&
+        strcmp(opStr, "mpk") != 0 && strcmp(opStr, "cheb") != 0 &&
+        strcmp(opStr, "cb") != 0 && strcmp(opStr, "dense") != 0 &&
+        strcmp(opStr, "il") != 0) {
+        printf("Unknown operation '%s'. Valid: ax, atx, ata, pair, dot, res, mpk, cheb, cb, dense, il\n", opStr);
+        fflush(stdout);
+        return 1;
+    }
+    if ((solveStr || eigStr) && (k > 1 || strcmp(opStr, "ax") != 0)) {
+        printf("Error: -solve and -eig are only implemented for -k 1 and -op ax.\n");
+        fflush(stdout);
+        return 1;
+    }
+    if (pfDist != 0 && (solveStr || eigStr || k > 1 || prec != PREC_DOUBLE || strcmp(opStr, "ax") != 0)) {
+        printf("Error: -pf is only implemented for the plain A x runs with -k 1 and -p double.\n");
+        fflush(stdout);
+        return 1;
+    }
+    if (ntStores && (pfDist != 0 || solveStr || eigStr || k > 1 || prec != PREC_DOUBLE || strcmp(opStr, "ax") != 0)) {
+        printf("Error: -store nt is only implemented for the plain A x runs with -k 1, -p double and without -pf.\n");
+        fflush(stdout);
+        return 1;
+    }
+    if (strcmp(opStr, "ax") != 0 && (k > 1 || prec != PREC_DOUBLE)) {
+        printf("Error: -op %s is only implemented for -k 1 and -p double.\n", opStr);
+        fflush(stdout);
+        return 1;
+    }
+
+    // Reordering runs only once every option is known to be valid, it costs
+    // the ordering plus two timed SpMV batches
+    idx_t *perm = NULL;
+    if (reorder != REORDER_NONE) {
+        if (rows != cols) {
+            printf("Error: -reorder needs a square matrix.\n");
+            fflush(stdout);
+            return 1;
+        }
+        printf("Reordering matrix...\n");
+        fflush(stdout);
+        perm = reorderMatrix(reorder, rows, &values, &colIndex, &rowPtr, runs);
+    }
+
+    // Reduced-precision copy of the values; the double array is kept for the error check
+    float *valuesF = NULL;
+    uint16_t *valuesH = NULL;
+    if (prec == PREC_FLOAT) {
+        printf("Converting values to float...\n");
+        fflush(stdout);
+        valuesF = (float *)arenaAlloc((size_t)nnz * sizeof(float));
+        if (!valuesF) {
+            printf("Error: memory allocation failed for float values.\n");
+            fflush(stdout);
+            return 1;
+        }
+        for (nnz_t j = 0; j < nnz; j++) valuesF[j] = (float)values[j];
+    } else if (prec == PREC_BF16) {
+        printf("Converting values to bfloat16...\n");
+        fflush(stdout);
+        valuesH = (uint16_t *)arenaAlloc((size_t)nnz * sizeof(uint16_t));
+        if (!valuesH) {
+            printf("Error: memory allocation failed for bf16 values.\n");
+            fflush(stdout);
+            return 1;
+        }
+        for (nnz_t j = 0; j < nnz; j++) valuesH[j] = floatToBF16((float)values[j]);
+    }
+
     printf("Allocating vectors...\n");
     fflush(stdout);
-    double *x = (double *)malloc(cols * sizeof(double));
-    double *y = (double *)malloc(rows * sizeof(double));
+    double *x = (double *)arenaAlloc((size_t)cols * sizeof(double));
+    double *y = (double *)arenaAlloc((size_t)rows * sizeof(double));
     double *times = (double *)malloc(runs * sizeof(double));
     if (!x || !y || !times) {
         printf("Error: memory allocation failed for vectors.\n");
         fflush(stdout);
-        free(triplets);
-        free(values);
-        free(colIndex);
-        free(rowPtr);
+        arenaFree(triplets);
+        arenaFree(values);
+        arenaFree(colIndex);
+        arenaFree(rowPtr);
         return 1;
     }
+    // Touch x and y now so the huge-page report covers them
+    memset(x, 0, (size_t)cols * sizeof(double));
+    memset(y, 0, (size_t)rows * sizeof(double));
+    arenaReport();
 
     // Configure OpenMP runtime scheduling based on user input
     omp_sched_t schedKind;
     if (!parseSchedule(schedStr, &schedKind)) {
         printf("Unknown schedule '%s'. Valid: static, dynamic, guided, auto\n", schedStr);
-        free(triplets);
-        free(values);
-        free(colIndex);
-        free(rowPtr);
-        free(x);
-        free(y);
+        arenaFree(triplets);
+        arenaFree(values);
+        arenaFree(colIndex);
+        arenaFree(rowPtr);
+        arenaFree(x);
+        arenaFree(y);
         free(times);
         return 1;
     }
@@ -311,24 +3328,113 @@ int main(int argc, char *argv[]) {
     printf("  Runs: %d\n", runs);
     printf("  Threads (omp_get_max_threads): %d\n", usedThreads);
     printf("  Schedule: %s  chunk=%d\n", schedStr, chunk);
+    printf("  Value precision: %s\n", precStr);
+    printf("  Vectors per multiply (k): %d\n", k);
+    printf("  Operation: %s\n", opStr);
+    printf("  Reordering: %s\n", reorderStr);
+    if (pfDist == PF_AUTO) printf("  Prefetch distance: auto\n");
+    else printf("  Prefetch distance: %d\n", pfDist);
+    printf("  y stores: %s\n", !ntStores ? "normal"
+                               : HAVE_STREAM_STORES ? "non-temporal"
+                               : "non-temporal requested, not available in this build (ordinary stores)");
+    if (solveStr) printf("  Solver: %s (maxit=%d, tol=%.1e)\n", solveStr, maxIter, tol);
+    if (eigStr) printf("  Eigen method: %s (maxit=%d)\n", eigStr, maxIter);
     fflush(stdout);
 
     srand((unsigned int)time(NULL));
 
-    printf("\nRunning %d matrix-vector multiplications (parallel)...\n", runs);
-    fflush(stdout);
+    if (prec != PREC_DOUBLE) {
+        double *yRef = (double *)malloc((size_t)rows * sizeof(double));
+        if (!yRef) {
+            printf("Error: memory allocation failed for reference vector.\n");
+            fflush(stdout);
+            return 1;
+        }
+        double err = precisionError(prec, rows, cols, values, valuesF, valuesH,
+                                    colIndex, rowPtr, x, y, yRef, 3);
+        printf("Max relative error vs double kernel (3 random x, ||.||_inf): %.3e\n", err);
+        fflush(stdout);
+        free(yRef);
+    }
 
-    for (int i = 0; i < runs; i++) {
-        for (int j = 0; j < cols; j++)
-            x[j] = (double)rand() / RAND_MAX;
+    if (solveStr) {
+        if (!benchmarkCG(prec, rows, values, valuesF, valuesH, colIndex, rowPtr, maxIter, tol, runs, times))
+            return 1;
+    } else if (eigStr) {
+        if (!benchmarkEig(eigMethod, prec, rows, values, valuesF, valuesH, colIndex, rowPtr,
+                          maxIter, tol, nev, runs, times))
+            return 1;
+    } else if (strcmp(opStr, "atx") == 0) {
+        if (!benchmarkTranspose(rows, cols, values, colIndex, rowPtr, transMethod, runs, times))
+            return 1;
+    } else if (strcmp(opStr, "ata") == 0 || strcmp(opStr, "pair") == 0) {
+        if (!benchmarkFused(rows, cols, values, colIndex, rowPtr, strcmp(opStr, "pair") == 0, runs, times))
+            return 1;
+    } else if (strcmp(opStr, "dot") == 0) {
+        if (!benchmarkDot(rows, cols, values, colIndex, rowPtr, runs, times))
+            return 1;
+    } else if (strcmp(opStr, "res") == 0) {
+        if (!benchmarkResidual(rows, cols, values, colIndex, rowPtr, runs, times))
+            return 1;
+    } else if (strcmp(opStr, "mpk") == 0) {
+        if (!benchmarkMPK(rows, cols, values, colIndex, rowPtr, mpkSteps, mpkBlock, runs, times))
+            return 1;
+    } else if (strcmp(opStr, "cheb") == 0) {
+        if (!benchmarkCheb(rows, cols, values, colIndex, rowPtr, chebDegree, lmin, lmax, runs, times))
+            return 1;
+    } else if (strcmp(opStr, "cb") == 0) {
+        if (!benchmarkColBlocked(rows, cols, values, colIndex, rowPtr, cacheLevel, runs, times))
+            return 1;
+    } else if (strcmp(opStr, "dense") == 0) {
+        if (!benchmarkDenseTiled(rows, cols, values, colIndex, rowPtr, denseFill, runs, times))
+            return 1;
+    } else if (strcmp(opStr, "il") == 0) {
+        if (!benchmarkInterleaved(rows, cols, values, colIndex, rowPtr, runs, times))
+            return 1;
+    } else if (k > 1) {
+        if (!benchmarkSpMM(rows, cols, values, colIndex, rowPtr, k, runs, times))
+            return 1;
+    } else {
+        printf("\nRunning %d matrix-vector multiplications (parallel)...\n", runs);
+        fflush(stdout);
 
-        double start = getMilliseconds();
-        csrMatVecMultiply(rows, values, colIndex, rowPtr, x, y);
-        double end = getMilliseconds();
+        if (pfDist == PF_AUTO)
+            pfDist = prefetchSweep(rows, cols, values, colIndex, rowPtr, x, y, runs);
 
-        times[i] = end - start;
-        printf("Run %d: %.6f ms\n", i + 1, times[i]);
-        fflush(stdout);
+        // With a reordering, x is permuted on the way in and y on the way out,
+        // outside the timed region
+        double *xp = perm ? (double *)malloc((size_t)cols * sizeof(double)) : x;
+        double *yp = perm ? (double *)malloc((size_t)rows * sizeof(double)) : y;
+        if (!xp || !yp) {
+            printf("Error: memory allocation failed for permuted vectors.\n");
+            fflush(stdout);
+            return 1;
+        }
+        for (int i = 0; i < runs; i++) {
+            for (idx_t j = 0; j < cols; j++)
+                x[j] = (double)rand() / RAND_MAX;
+            if (perm)
+                for (idx_t j = 0; j < cols; j++) xp[j] = x[perm[j]];
+
+            double start = getMilliseconds();
+            if (pfDist > 0)
+                csrMatVecMultiplyPF(rows, values, colIndex, rowPtr, xp, yp, pfDist);
+            else if (ntStores)
+                csrMatVecMultiplyNT(rows, values, colIndex, rowPtr, xp, yp);
+            else
+                csrMatVecMultiplyPrec(prec, rows, values, valuesF, valuesH, colIndex, rowPtr, xp, yp);
+            double end = getMilliseconds();
+            if (perm)
+                for (idx_t j = 0; j < rows; j++) y[perm[j]] = yp[j];
+
+            times[i] = end - start;
+            printf("Run %d: %.6f ms\n", i + 1, times[i]);
+            fflush(stdout);
+        }
+        if (perm) {
+            free(xp);
+            free(yp);
+        }
     }
 
     printf("Saving all %d runs to file...\n", runs);
@@ -349,13 +3455,17 @@ int main(int argc, char *argv[]) {
         fflush(stdout);
     }
 
-    free(triplets);
-    free(values);
-    free(colIndex);
-    free(rowPtr);
-    free(x);
-    free(y);
+    arenaFree(triplets);
+    arenaFree(values);
+    arenaFree(colIndex);
+    arenaFree(rowPtr);
+    arenaFree(valuesF);
+    arenaFree(valuesH);
+    free(perm);
+    arenaFree(x);
+    arenaFree(y);
     free(times);
+    arenaRelease();
 
     printf("Program completed successfully.\n");
     fflush(stdout);
@@ -6,25 +6,56 @@
 #include <time.h>
 #include <string.h>
 #include <omp.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <limits.h>
+
+// ---------- Index width ----------
+// Two index types: nnz_t counts and addresses nonzeros (rowPtr, nnz), idx_t
+// holds rows and columns (colIndex, triplet indices). Both are 32-bit by
+// default. -DMVM_INDEX64 widens nnz_t only, for matrices with more than
+// 2^31 - 1 nonzeros, so colIndex stays at 4 bytes per nonzero. -DMVM_COL64
+// also widens idx_t, for dimensions beyond 2^31 - 1 (the loader tells you
+// which one a matrix needs).
+#if defined(MVM_INDEX64) || defined(MVM_COL64)
+typedef int64_t nnz_t;
+#define NNZ_FMT "%" PRId64
+#define NNZ_MAX INT64_MAX
+#else
+typedef int nnz_t;
+#define NNZ_FMT "%d"
+#define NNZ_MAX INT_MAX
+#endif
+#ifdef MVM_COL64
+typedef int64_t idx_t;
+#define IDX_FMT "%" PRId64
+#define IDX_SCN "%" SCNd64
+#define IDX_MAX INT64_MAX
+#else
+typedef int idx_t;
+#define IDX_FMT "%d"
+#define IDX_SCN "%d"
+#define IDX_MAX INT_MAX
+#endif
 
 typedef struct {
-    int row;
-    int col;
+    idx_t row;
+    idx_t col;
     double val;
 } Triplet;
 
 int cmpTriplet(const void *a, const void *b) {
     const Triplet *ta = (const Triplet *)a;
     const Triplet *tb = (const Triplet *)b;
-    if (ta->row != tb->row) return ta->row - tb->row;
-    return ta->col - tb->col;
+    if (ta->row != tb->row) return (ta->row > tb->row) - (ta->row < tb->row);
+    return (ta->col > tb->col) - (ta->col < tb->col);
 }
 
-void convertToCSR(Triplet *triplets, int nnz, int rows, int cols,
-                  double **values, int **colIndex, int **rowPtr) {
-    *values = (double *)malloc(nnz * sizeof(double));
-    *colIndex = (int *)malloc(nnz * sizeof(int));
-    *rowPtr = (int *)calloc((rows + 1), sizeof(int));
+void convertToCSR(Triplet *triplets, nnz_t nnz, idx_t rows, idx_t cols,
+                  double **values, idx_t **colIndex, nnz_t **rowPtr) {
+    *values = (double *)malloc((size_t)nnz * sizeof(double));
+    *colIndex = (idx_t *)malloc((size_t)nnz * sizeof(idx_t));
+    *rowPtr = (nnz_t *)calloc((size_t)rows + 1, sizeof(nnz_t));
 
     if (!(*values) || !(*colIndex) || !(*rowPtr)) {
         printf("Error: memory allocation failed in CSR conversion.\n");
@@ -32,24 +63,24 @@ void convertToCSR(Triplet *triplets, int nnz, int rows, int cols,
         exit(1);
     }
 
-    for (int i = 0; i < nnz; i++) {
+    for (nnz_t i = 0; i < nnz; i++) {
         (*rowPtr)[triplets[i].row + 1]++;
     }
-    for (int i = 0; i < rows; i++) {
+    for (idx_t i = 0; i < rows; i++) {
         (*rowPtr)[i + 1] += (*rowPtr)[i];
     }
 
-    int *writePtr = (int *)malloc((rows + 1) * sizeof(int));
+    nnz_t *writePtr = (nnz_t *)malloc(((size_t)rows + 1) * sizeof(nnz_t));
     if (!writePtr) {
         printf("Error: memory allocation failed in CSR conversion (writePtr).\n");
         fflush(stdout);
         exit(1);
     }
-    for (int i = 0; i <= rows; i++) writePtr[i] = (*rowPtr)[i];
+    for (idx_t i = 0; i <= rows; i++) writePtr[i] = (*rowPtr)[i];
 
-    for (int i = 0; i < nnz; i++) {
-        int row = triplets[i].row;
-        int dest = writePtr[row];
+    for (nnz_t i = 0; i < nnz; i++) {
+        idx_t row = triplets[i].row;
+        nnz_t dest = writePtr[row];
         (*values)[dest] = triplets[i].val;
         (*colIndex)[dest] = triplets[i].col;
         writePtr[row]++;
@@ -59,10 +90,10 @@ void convertToCSR(Triplet *triplets, int nnz, int rows, int cols,
 }
 
 // Helper function: find which row a given non-zero element belongs to (binary search)
-int findRow(int k, int *rowPtr, int rows) {
-    int low = 0, high = rows - 1;
+idx_t findRow(nnz_t k, nnz_t *rowPtr, idx_t rows) {
+    idx_t low = 0, high = rows - 1;
     while (low <= high) {
-        int mid = (low + high) / 2;
+        idx_t mid = low + (high - low) / 2;
         if (rowPtr[mid] <= k && k < rowPtr[mid + 1]) {
             return mid;
         } else if (k < rowPtr[mid]) {
@@ -78,20 +109,20 @@ int findRow(int k, int *rowPtr, int rows) {
 // Parallelize over non-zero elements instead of rows
 // Each thread processes one element and atomically updates y[row]
 // Better load balancing for very sparse rows, but has synchronization overhead
-void csrMatVecMultiply(int rows, double *values, int *colIndex, int *rowPtr,
+void csrMatVecMultiply(idx_t rows, double *values, idx_t *colIndex, nnz_t *rowPtr,
                        double *x, double *y) {
     // Initialize y
     #pragma omp parallel for schedule(runtime)
-    for (int i = 0; i < rows; i++) {
+    for (idx_t i = 0; i < rows; i++) {
         y[i] = 0.0;
     }
 
     // Parallelize over all non-zero elements
-    int total_nnz = rowPtr[rows];
+    nnz_t total_nnz = rowPtr[rows];
     #pragma omp parallel for schedule(runtime)
-    for (int k = 0; k < total_nnz; k++) {
+    for (nnz_t k = 0; k < total_nnz; k++) {
         // Find which row this element belongs to using binary search
-        int row = findRow(k, rowPtr, rows);
+        idx_t row = findRow(k, rowPtr, rows);
         
         // Compute product
         double product = values[k] * x[colIndex[k]];
@@ -196,25 +227,41 @@ int main(int argc, char *argv[]) {
     printf("Reading matrix header...\n");
     fflush(stdout);
 
-    int rows, cols, nnz;
-    if (fscanf(fin, "%d %d %d", &rows, &cols, &nnz) != 3) {
+    long long hdrRows, hdrCols, hdrNnz;
+    if (fscanf(fin, "%lld %lld %lld", &hdrRows, &hdrCols, &hdrNnz) != 3) {
         printf("Error: invalid matrix header.\n");
         fflush(stdout);
         fclose(fin);
         return 1;
     }
 
-    printf("Matrix dimensions: %d x %d with %d non-zero elements\n", rows, cols, nnz);
+    printf("Matrix dimensions: %lld x %lld with %lld non-zero elements\n", hdrRows, hdrCols, hdrNnz);
     fflush(stdout);
 
-    if (rows <= 0 || cols <= 0 || nnz <= 0) {
+    if (hdrRows <= 0 || hdrCols <= 0 || hdrNnz <= 0) {
         printf("Error: invalid matrix dimensions (must be positive).\n");
         fflush(stdout);
         fclose(fin);
         return 1;
     }
+    if (hdrNnz > NNZ_MAX) {
+        printf("Error: %lld nonzeros do not fit in %d-bit offsets, rebuild with -DMVM_INDEX64.\n",
+               hdrNnz, (int)(8 * sizeof(nnz_t)));
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+    if (hdrRows > IDX_MAX || hdrCols > IDX_MAX) {
+        printf("Error: matrix dimensions do not fit in %d-bit indices, rebuild with -DMVM_COL64.\n",
+               (int)(8 * sizeof(idx_t)));
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+    idx_t rows = (idx_t)hdrRows, cols = (idx_t)hdrCols;
+    nnz_t nnz = (nnz_t)hdrNnz;
 
-    Triplet *triplets = (Triplet *)malloc(nnz * sizeof(Triplet));
+    Triplet *triplets = (Triplet *)malloc((size_t)nnz * sizeof(Triplet));
     if (!triplets) {
         printf("Error: memory allocation failed for triplets.\n");
         fflush(stdout);
@@ -225,11 +272,11 @@ int main(int argc, char *argv[]) {
     printf("Reading matrix elements...\n");
     fflush(stdout);
 
-    int maxRow = 0, maxCol = 0;
+    idx_t maxRow = 0, maxCol = 0;
 
-    for (int i = 0; i < nnz; i++) {
-        if (fscanf(fin, "%d %d %lf", &triplets[i].row, &triplets[i].col, &triplets[i].val) != 3) {
-            printf("Error: invalid matrix element at entry %d.\n", i + 1);
+    for (nnz_t i = 0; i < nnz; i++) {
+        if (fscanf(fin, IDX_SCN " " IDX_SCN " %lf", &triplets[i].row, &triplets[i].col, &triplets[i].val) != 3) {
+            printf("Error: invalid matrix element at entry " NNZ_FMT ".\n", i + 1);
             fflush(stdout);
             fclose(fin);
             free(triplets);
@@ -242,16 +289,16 @@ int main(int argc, char *argv[]) {
     if (maxRow == rows || maxCol == cols) {
         printf("Detected 1-based indexing, converting to 0-based...\n");
         fflush(stdout);
-        for (int i = 0; i < nnz; i++) {
+        for (nnz_t i = 0; i < nnz; i++) {
             triplets[i].row--;
             triplets[i].col--;
         }
     }
 
-    for (int i = 0; i < nnz; i++) {
+    for (nnz_t i = 0; i < nnz; i++) {
         if (triplets[i].row < 0 || triplets[i].row >= rows ||
             triplets[i].col < 0 || triplets[i].col >= cols) {
-            printf("Error: invalid indices at entry %d (row=%d, col=%d)\n",
+            printf("Error: invalid indices at entry " NNZ_FMT " (row=" IDX_FMT ", col=" IDX_FMT ")\n",
                    i + 1, triplets[i].row, triplets[i].col);
             fflush(stdout);
             fclose(fin);
@@ -265,18 +312,19 @@ int main(int argc, char *argv[]) {
 
     printf("Sorting triplets using qsort...\n");
     fflush(stdout);
-    qsort(triplets, nnz, sizeof(Triplet), cmpTriplet);
+    qsort(triplets, (size_t)nnz, sizeof(Triplet), cmpTriplet);
 
     printf("Converting to CSR format...\n");
     fflush(stdout);
     double *values;
-    int *colIndex, *rowPtr;
+    idx_t *colIndex;
+    nnz_t *rowPtr;
     convertToCSR(triplets, nnz, rows, cols, &values, &colIndex, &rowPtr);
 
     printf("Allocating vectors...\n");
     fflush(stdout);
-    double *x = (double *)malloc(cols * sizeof(double));
-    double *y = (double *)malloc(rows * sizeof(double));
+    double *x = (double *)malloc((size_t)cols * sizeof(double));
+    double *y = (double *)malloc((size_t)rows * sizeof(double));
     double *times = (double *)malloc(runs * sizeof(double));
 
     if (!x || !y || !times) {
@@ -321,7 +369,7 @@ int main(int argc, char *argv[]) {
     fflush(stdout);
 
     for (int i = 0; i < runs; i++) {
-        for (int j = 0; j < cols; j++)
+        for (idx_t j = 0; j < cols; j++)
             x[j] = (double)rand() / RAND_MAX;
 
         double start = getMilliseconds();
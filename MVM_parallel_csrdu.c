@@ -0,0 +1,640 @@
+// Build with -fopenmp (gcc) or /openmp (MSVC)
+// CSR-DU: CSR with delta-encoded, variable-width column indices.
+// Rows are grouped in blocks; each block stores one base column and the
+// column offsets of its nonzeros packed in 8, 16 or 32 bits, depending on
+// the column span of the block. Add -march=native so the decode loops can
+// use vector gathers. With -w 16 the 8-bit width is not used, which gives
+// plain 16-bit panel offsets with a per-block 32-bit fallback.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <omp.h>
+#include <inttypes.h>
+#include <limits.h>
+
+// ---------- Index width ----------
+// Two index types: nnz_t counts and addresses nonzeros (rowPtr, nnz), idx_t
+// holds rows and columns (colIndex, triplet indices). Both are 32-bit by
+// default. -DMVM_INDEX64 widens nnz_t only, for matrices with more than
+// 2^31 - 1 nonzeros, so colIndex stays at 4 bytes per nonzero. -DMVM_COL64
+// also widens idx_t, for dimensions beyond 2^31 - 1 (the loader tells you
+// which one a matrix needs).
+#if defined(MVM_INDEX64) || defined(MVM_COL64)
+typedef int64_t nnz_t;
+#define NNZ_FMT "%" PRId64
+#define NNZ_MAX INT64_MAX
+#else
+typedef int nnz_t;
+#define NNZ_FMT "%d"
+#define NNZ_MAX INT_MAX
+#endif
+#ifdef MVM_COL64
+typedef int64_t idx_t;
+#define IDX_FMT "%" PRId64
+#define IDX_SCN "%" SCNd64
+#define IDX_MAX INT64_MAX
+#else
+typedef int idx_t;
+#define IDX_FMT "%d"
+#define IDX_SCN "%d"
+#define IDX_MAX INT_MAX
+#endif
+
+typedef struct {
+    idx_t row;
+    idx_t col;
+    double val;
+} Triplet;
+
+// ---------- CSR-DU structure ----------
+typedef struct {
+    idx_t rows;
+    idx_t cols;
+    nnz_t nnz;
+    int blockRows;          // rows per block
+    idx_t blocks;
+    nnz_t *rowPtr;          // same row pointer as CSR
+    double *values;         // same values as CSR
+    idx_t *blockBase;       // smallest column index in the block
+    unsigned char *blockWidth; // bytes per delta: 1, 2, 4 (or 8 with 64-bit column indices)
+    size_t *blockOffset;    // byte offset of the block in deltas
+    unsigned char *deltas;  // packed (col - blockBase) per nonzero
+    size_t deltaBytes;
+} CSRDU;
+
+// ---------- Quick Sort ----------
+int cmpTriplet(const void *a, const void *b) {
+    const Triplet *ta = (const Triplet *)a;
+    const Triplet *tb = (const Triplet *)b;
+    if (ta->row != tb->row) return (ta->row > tb->row) - (ta->row < tb->row);
+    return (ta->col > tb->col) - (ta->col < tb->col);
+}
+
+// ---------- CSR Conversion ----------
+void convertToCSR(Triplet *triplets, nnz_t nnz, idx_t rows, idx_t cols,
+                  double **values, idx_t **colIndex, nnz_t **rowPtr) {
+    *values = (double *)malloc((size_t)nnz * sizeof(double));
+    *colIndex = (idx_t *)malloc((size_t)nnz * sizeof(idx_t));
+    *rowPtr = (nnz_t *)calloc((size_t)rows + 1, sizeof(nnz_t));
+
+    if (!(*values) || !(*colIndex) || !(*rowPtr)) {
+        printf("Error: memory allocation failed in CSR conversion.\n");
+        fflush(stdout);
+        exit(1);
+    }
+
+    for (nnz_t i = 0; i < nnz; i++) {
+        (*rowPtr)[triplets[i].row + 1]++;
+    }
+    for (idx_t i = 0; i < rows; i++) {
+        (*rowPtr)[i + 1] += (*rowPtr)[i];
+    }
+
+    // We fill from the end of each row bucket, so make a copy of rowPtr to use as write pointers
+    nnz_t *writePtr = (nnz_t *)malloc(((size_t)rows + 1) * sizeof(nnz_t));
+    if (!writePtr) {
+        printf("Error: memory allocation failed in CSR conversion (writePtr).\n");
+        fflush(stdout);
+        exit(1);
+    }
+    for (idx_t i = 0; i <= rows; i++) writePtr[i] = (*rowPtr)[i];
+
+    for (nnz_t i = 0; i < nnz; i++) {
+        idx_t row = triplets[i].row;
+        nnz_t dest = writePtr[row];
+        (*values)[dest] = triplets[i].val;
+        (*colIndex)[dest] = triplets[i].col;
+        writePtr[row]++;
+    }
+
+    free(writePtr);
+}
+
+// ---------- CSR -> CSR-DU Conversion ----------
+// The values and row pointer are shared with the CSR arrays, only the
+// column indices are re-encoded. Each block is padded so that its deltas
+// start on a multiple of their own width. A block whose span does not fit
+// the narrow widths falls back to 32 (or 64) bits on its own.
+CSRDU *convertToCSRDU(idx_t rows, idx_t cols, double *values, idx_t *colIndex,
+                      nnz_t *rowPtr, int blockRows, int minWidth) {
+    CSRDU *D = (CSRDU *)calloc(1, sizeof(CSRDU));
+    if (!D) {
+        printf("Error: memory allocation failed in CSR-DU conversion.\n");
+        fflush(stdout);
+        exit(1);
+    }
+    D->rows = rows;
+    D->cols = cols;
+    D->nnz = rowPtr[rows];
+    D->blockRows = blockRows;
+    D->blocks = (rows + blockRows - 1) / blockRows;
+    D->rowPtr = rowPtr;
+    D->values = values;
+    D->blockBase = (idx_t *)malloc((size_t)D->blocks * sizeof(idx_t));
+    D->blockWidth = (unsigned char *)malloc((size_t)D->blocks * sizeof(unsigned char));
+    D->blockOffset = (size_t *)malloc((size_t)D->blocks * sizeof(size_t));
+    if (!D->blockBase || !D->blockWidth || !D->blockOffset) {
+        printf("Error: memory allocation failed in CSR-DU conversion (blocks).\n");
+        fflush(stdout);
+        exit(1);
+    }
+
+    // First pass: base column, width and offset of every block
+    size_t bytes = 0;
+    for (idx_t b = 0; b < D->blocks; b++) {
+        idx_t r0 = b * blockRows;
+        idx_t r1 = (r0 + blockRows < rows) ? r0 + blockRows : rows;
+        idx_t minCol = cols, maxCol = 0;
+        for (nnz_t j = rowPtr[r0]; j < rowPtr[r1]; j++) {
+            if (colIndex[j] < minCol) minCol = colIndex[j];
+            if (colIndex[j] > maxCol) maxCol = colIndex[j];
+        }
+        if (minCol > maxCol) minCol = maxCol = 0; // empty block
+
+        uint64_t span = (uint64_t)(maxCol - minCol);
+        int width = (span <= 0xFF) ? 1 : (span <= 0xFFFF) ? 2 : (span <= 0xFFFFFFFFu) ? 4 : 8;
+        if (width < minWidth) width = minWidth;
+
+        bytes = (bytes + width - 1) / width * width;
+        D->blockBase[b] = minCol;
+        D->blockWidth[b] = (unsigned char)width;
+        D->blockOffset[b] = bytes;
+        bytes += (size_t)(rowPtr[r1] - rowPtr[r0]) * width;
+    }
+    D->deltaBytes = bytes;
+
+    // Second pass: pack the deltas
+    D->deltas = (unsigned char *)malloc(bytes > 0 ? bytes : 1);
+    if (!D->deltas) {
+        printf("Error: memory allocation failed in CSR-DU conversion (deltas).\n");
+        fflush(stdout);
+        exit(1);
+    }
+    #pragma omp parallel for schedule(static)
+    for (idx_t b = 0; b < D->blocks; b++) {
+        idx_t r0 = b * blockRows;
+        idx_t r1 = (r0 + blockRows < rows) ? r0 + blockRows : rows;
+        nnz_t start = rowPtr[r0], end = rowPtr[r1];
+        idx_t base = D->blockBase[b];
+        unsigned char *p = D->deltas + D->blockOffset[b];
+        if (D->blockWidth[b] == 1) {
+            uint8_t *d = (uint8_t *)p;
+            for (nnz_t j = start; j < end; j++) d[j - start] = (uint8_t)(colIndex[j] - base);
+        } else if (D->blockWidth[b] == 2) {
+            uint16_t *d = (uint16_t *)p;
+            for (nnz_t j = start; j < end; j++) d[j - start] = (uint16_t)(colIndex[j] - base);
+        } else if (D->blockWidth[b] == 4) {
+            uint32_t *d = (uint32_t *)p;
+            for (nnz_t j = start; j < end; j++) d[j - start] = (uint32_t)(colIndex[j] - base);
+        } else {
+            uint64_t *d = (uint64_t *)p;
+            for (nnz_t j = start; j < end; j++) d[j - start] = (uint64_t)(colIndex[j] - base);
+        }
+    }
+
+    return D;
+}
+
+void freeCSRDU(CSRDU *D) {
+    free(D->blockBase);
+    free(D->blockWidth);
+    free(D->blockOffset);
+    free(D->deltas);
+    free(D);
+}
+
+// ---------- Matrix-Vector Multiplication (CSR, parallelized with OpenMP) ----------
+void csrMatVecMultiply(idx_t rows, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                       double *x, double *y) {
+    // Each row is independent so we parallelize over rows.
+    #pragma omp parallel for schedule(runtime)
+    for (idx_t i = 0; i < rows; i++) {
+        double sum = 0.0;
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++) {
+            sum += values[j] * x[colIndex[j]];
+        }
+        y[i] = sum;
+    }
+}
+
+// ---------- Matrix-Vector Multiplication (CSR-DU) ----------
+// Blocks are independent so we parallelize over blocks. The width is
+// fixed inside a block, so each inner loop decodes base + delta with a
+// single add and can be vectorized.
+void csrduMatVecMultiply(const CSRDU *D, const double *x, double *y) {
+    const nnz_t *rowPtr = D->rowPtr;
+    const double *values = D->values;
+
+    #pragma omp parallel for schedule(runtime)
+    for (idx_t b = 0; b < D->blocks; b++) {
+        idx_t r0 = b * D->blockRows;
+        idx_t r1 = (r0 + D->blockRows < D->rows) ? r0 + D->blockRows : D->rows;
+        nnz_t start = rowPtr[r0];
+        const double *xb = x + D->blockBase[b];
+        const unsigned char *p = D->deltas + D->blockOffset[b];
+
+        if (D->blockWidth[b] == 1) {
+            const uint8_t *d = (const uint8_t *)p;
+            for (idx_t i = r0; i < r1; i++) {
+                double sum = 0.0;
+                #pragma omp simd reduction(+:sum)
+                for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+                    sum += values[j] * xb[d[j - start]];
+                y[i] = sum;
+            }
+        } else if (D->blockWidth[b] == 2) {
+            const uint16_t *d = (const uint16_t *)p;
+            for (idx_t i = r0; i < r1; i++) {
+                double sum = 0.0;
+                #pragma omp simd reduction(+:sum)
+                for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+                    sum += values[j] * xb[d[j - start]];
+                y[i] = sum;
+            }
+        } else if (D->blockWidth[b] == 4) {
+            const uint32_t *d = (const uint32_t *)p;
+            for (idx_t i = r0; i < r1; i++) {
+                double sum = 0.0;
+                #pragma omp simd reduction(+:sum)
+                for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+                    sum += values[j] * xb[d[j - start]];
+                y[i] = sum;
+            }
+        } else {
+            const uint64_t *d = (const uint64_t *)p;
+            for (idx_t i = r0; i < r1; i++) {
+                double sum = 0.0;
+                for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+                    sum += values[j] * xb[d[j - start]];
+                y[i] = sum;
+            }
+        }
+    }
+}
+
+// ---------- Time in milliseconds ----------
+double getMilliseconds() {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);  // get current time in UTC
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6; // convert to milliseconds
+}
+
+// ---------- Command-line utilities ----------
+void printUsage(const char *prog) {
+    printf("Usage: %s <matrix_file> [-r runs] [-t threads] [-s schedule] [-c chunk] [-b block_rows] [-w bits]\n", prog);
+    printf("  -r runs       : number of runs (default 10)\n");
+    printf("  -t threads    : number of OpenMP threads (default = hardware)\n");
+    printf("  -s schedule   : schedule: static | dynamic | guided | auto (default guided)\n");
+    printf("  -c chunk      : chunk size for schedule (integer, default 0)\n");
+    printf("  -b block_rows : rows sharing one base column and delta width (default 16)\n");
+    printf("  -w bits       : narrowest delta width, 8 or 16 (default 8)\n");
+    printf("Example: %s matrix.txt -r 20 -t 8 -s guided -c 16 -b 8\n", prog);
+}
+
+// Map schedule string to omp_sched_t
+int parseSchedule(const char *s, omp_sched_t *outKind) {
+    if (!s) return 0;
+    if (strcmp(s, "static") == 0) { *outKind = omp_sched_static; return 1; }
+    if (strcmp(s, "dynamic") == 0) { *outKind = omp_sched_dynamic; return 1; }
+    if (strcmp(s, "guided") == 0) { *outKind = omp_sched_guided; return 1; }
+    if (strcmp(s, "auto") == 0)   { *outKind = omp_sched_auto;   return 1; }
+    return 0;
+}
+
+// ---------- Main ----------
+int main(int argc, char *argv[]) {
+    printf("=== Sparse Matrix Program (CSR-DU) Starting ===\n");
+    fflush(stdout);
+
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Defaults
+    char *filename = argv[1];
+    int runs = 10;
+    int threads = 0; // 0 means leave to OpenMP default/hardware
+    const char *schedStr = "guided";
+    int chunk = 0;
+    int blockRows = 16;
+    int minBits = 8;
+
+    // Parse optional args
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+            if (runs <= 0) runs = 10;
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+            if (threads < 0) threads = 0;
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            schedStr = argv[++i];
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            chunk = atoi(argv[++i]);
+            if (chunk < 0) chunk = 0;
+        } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            blockRows = atoi(argv[++i]);
+            if (blockRows <= 0) blockRows = 16;
+        } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            minBits = atoi(argv[++i]);
+            if (minBits != 8 && minBits != 16) minBits = 8;
+        } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            printf("Unknown option: %s\n", argv[i]);
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    printf("Attempting to open file: %s\n", filename);
+    fflush(stdout);
+
+    FILE *fin = fopen(filename, "r");
+    if (!fin) {
+        printf("Error: cannot open file '%s'\n", filename);
+        fflush(stdout);
+        return 1;
+    }
+
+    printf("File opened successfully!\n");
+    fflush(stdout);
+
+    // Skip all comment lines starting with %
+    int comment_count = 0;
+    int ch;
+    while ((ch = fgetc(fin)) != EOF) {
+        if (ch == '%') {
+            while ((ch = fgetc(fin)) != EOF && ch != '\n');
+            comment_count++;
+        } else {
+            ungetc(ch, fin);
+            break;
+        }
+    }
+
+    printf("Skipped %d comment line(s).\n", comment_count);
+    fflush(stdout);
+
+    if (ch == EOF) {
+        printf("Error: file contains only comments or is empty.\n");
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+
+    printf("Reading matrix header...\n");
+    fflush(stdout);
+
+    long long hdrRows, hdrCols, hdrNnz;
+    if (fscanf(fin, "%lld %lld %lld", &hdrRows, &hdrCols, &hdrNnz) != 3) {
+        printf("Error: invalid matrix header.\n");
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+
+    printf("Matrix dimensions: %lld x %lld with %lld non-zero elements\n", hdrRows, hdrCols, hdrNnz);
+    fflush(stdout);
+
+    if (hdrRows <= 0 || hdrCols <= 0 || hdrNnz <= 0) {
+        printf("Error: invalid matrix dimensions (must be positive).\n");
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+    if (hdrNnz > NNZ_MAX) {
+        printf("Error: %lld nonzeros do not fit in %d-bit offsets, rebuild with -DMVM_INDEX64.\n",
+               hdrNnz, (int)(8 * sizeof(nnz_t)));
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+    if (hdrRows > IDX_MAX || hdrCols > IDX_MAX) {
+        printf("Error: matrix dimensions do not fit in %d-bit indices, rebuild with -DMVM_COL64.\n",
+               (int)(8 * sizeof(idx_t)));
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+    idx_t rows = (idx_t)hdrRows, cols = (idx_t)hdrCols;
+    nnz_t nnz = (nnz_t)hdrNnz;
+
+    Triplet *triplets = (Triplet *)malloc((size_t)nnz * sizeof(Triplet));
+    if (!triplets) {
+        printf("Error: memory allocation failed for triplets.\n");
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+
+    printf("Reading matrix elements...\n");
+    fflush(stdout);
+
+    idx_t maxRow = 0, maxCol = 0;
+
+    for (nnz_t i = 0; i < nnz; i++) {
+        if (fscanf(fin, IDX_SCN " " IDX_SCN " %lf", &triplets[i].row, &triplets[i].col, &triplets[i].val) != 3) {
+            printf("Error: invalid matrix element at entry " NNZ_FMT ".\n", i + 1);
+            fflush(stdout);
+            fclose(fin);
+            free(triplets);
+            return 1;
+        }
+        if (triplets[i].row > maxRow) maxRow = triplets[i].row;
+        if (triplets[i].col > maxCol) maxCol = triplets[i].col;
+    }
+
+    // If indices are 1-based, subtract 1 from all
+    if (maxRow == rows || maxCol == cols) {
+        printf("Detected 1-based indexing, converting to 0-based...\n");
+        fflush(stdout);
+        for (nnz_t i = 0; i < nnz; i++) {
+            triplets[i].row--;
+            triplets[i].col--;
+        }
+    }
+
+    // Validate indices
+    for (nnz_t i = 0; i < nnz; i++) {
+        if (triplets[i].row < 0 || triplets[i].row >= rows ||
+            triplets[i].col < 0 || triplets[i].col >= cols) {
+            printf("Error: invalid indices at entry " NNZ_FMT " (row=" IDX_FMT ", col=" IDX_FMT ")\n",
+                   i + 1, triplets[i].row, triplets[i].col);
+            fflush(stdout);
+            fclose(fin);
+            free(triplets);
+            return 1;
+        }
+    }
+    fclose(fin);
+    printf("Matrix data loaded successfully!\n");
+    fflush(stdout);
+
+    printf("Sorting triplets using qsort...\n");
+    fflush(stdout);
+    qsort(triplets, (size_t)nnz, sizeof(Triplet), cmpTriplet);
+
+    printf("Converting to CSR format...\n");
+    fflush(stdout);
+    double *values;
+    idx_t *colIndex;
+    nnz_t *rowPtr;
+    convertToCSR(triplets, nnz, rows, cols, &values, &colIndex, &rowPtr);
+
+    printf("Converting CSR to CSR-DU (block rows = %d, narrowest delta %d bits)...\n", blockRows, minBits);
+    fflush(stdout);
+    double convStart = getMilliseconds();
+    CSRDU *D = convertToCSRDU(rows, cols, values, colIndex, rowPtr, blockRows, minBits / 8);
+    double convEnd = getMilliseconds();
+
+    // Storage report: index bytes are what CSR-DU compresses, values are untouched
+    long long blocksByWidth[9] = {0};
+    long long nnzByWidth[9] = {0};
+    for (idx_t b = 0; b < D->blocks; b++) {
+        idx_t r0 = b * blockRows;
+        idx_t r1 = (r0 + blockRows < rows) ? r0 + blockRows : rows;
+        blocksByWidth[D->blockWidth[b]]++;
+        nnzByWidth[D->blockWidth[b]] += rowPtr[r1] - rowPtr[r0];
+    }
+    double csrIndexBytes = (double)nnz * sizeof(idx_t) + (double)(rows + 1) * sizeof(nnz_t);
+    double duIndexBytes = (double)D->deltaBytes + (double)(rows + 1) * sizeof(nnz_t)
+                        + (double)D->blocks * (sizeof(idx_t) + sizeof(unsigned char) + sizeof(size_t));
+    double csrBytes = csrIndexBytes + (double)nnz * sizeof(double);
+    double duBytes = duIndexBytes + (double)nnz * sizeof(double);
+    double vecBytes = (double)cols * sizeof(double) + (double)rows * sizeof(double);
+
+    printf("\nCSR-DU storage:\n");
+    printf("  Conversion time: %.6f ms\n", convEnd - convStart);
+    printf("  Blocks: " IDX_FMT "  (8-bit: %lld, 16-bit: %lld, 32-bit: %lld, 64-bit: %lld)\n",
+           D->blocks, blocksByWidth[1], blocksByWidth[2], blocksByWidth[4], blocksByWidth[8]);
+    printf("  Nonzeros per width: 8-bit: %lld, 16-bit: %lld, 32-bit: %lld, 64-bit: %lld\n",
+           nnzByWidth[1], nnzByWidth[2], nnzByWidth[4], nnzByWidth[8]);
+    printf("  Fallback to 32/64-bit: %lld of " IDX_FMT " blocks (%.1f%% of nonzeros)\n",
+           blocksByWidth[4] + blocksByWidth[8], D->blocks,
+           100.0 * (nnzByWidth[4] + nnzByWidth[8]) / (nnz ? nnz : 1));
+    printf("  Index bytes  CSR: %.0f  CSR-DU: %.0f  (compression ratio %.3f)\n",
+           csrIndexBytes, duIndexBytes, csrIndexBytes / duIndexBytes);
+    printf("  Matrix bytes CSR: %.0f  CSR-DU: %.0f  (compression ratio %.3f)\n",
+           csrBytes, duBytes, csrBytes / duBytes);
+    fflush(stdout);
+
+    printf("Allocating vectors...\n");
+    fflush(stdout);
+    double *x = (double *)malloc((size_t)cols * sizeof(double));
+    double *y = (double *)malloc((size_t)rows * sizeof(double));
+    double *yRef = (double *)malloc((size_t)rows * sizeof(double));
+    double *times = (double *)malloc(runs * sizeof(double));
+    double *csrTimes = (double *)malloc(runs * sizeof(double));
+    if (!x || !y || !yRef || !times || !csrTimes) {
+        printf("Error: memory allocation failed for vectors.\n");
+        fflush(stdout);
+        return 1;
+    }
+
+    // Configure OpenMP runtime scheduling based on user input
+    omp_sched_t schedKind;
+    if (!parseSchedule(schedStr, &schedKind)) {
+        printf("Unknown schedule '%s'. Valid: static, dynamic, guided, auto\n", schedStr);
+        return 1;
+    }
+
+    if (threads > 0) {
+        omp_set_num_threads(threads);
+    }
+    omp_set_schedule(schedKind, chunk);
+
+    int usedThreads = omp_get_max_threads();
+    printf("\nRuntime configuration:\n");
+    printf("  Runs: %d\n", runs);
+    printf("  Threads (omp_get_max_threads): %d\n", usedThreads);
+    printf("  Schedule: %s  chunk=%d\n", schedStr, chunk);
+    printf("  Block rows: %d\n", blockRows);
+    printf("  Narrowest delta: %d bits\n", minBits);
+    fflush(stdout);
+
+    srand((unsigned int)time(NULL));
+
+    // Check the decoded kernel against plain CSR once before timing
+    for (idx_t j = 0; j < cols; j++)
+        x[j] = (double)rand() / RAND_MAX;
+    csrMatVecMultiply(rows, values, colIndex, rowPtr, x, yRef);
+    csrduMatVecMultiply(D, x, y);
+    double maxDiff = 0.0;
+    for (idx_t i = 0; i < rows; i++) {
+        double d = y[i] - yRef[i];
+        if (d < 0) d = -d;
+        if (d > maxDiff) maxDiff = d;
+    }
+    printf("Max abs difference CSR-DU vs CSR: %.3e\n", maxDiff);
+    fflush(stdout);
+
+    printf("\nRunning %d matrix-vector multiplications (CSR-DU, CSR reference)...\n", runs);
+    fflush(stdout);
+
+    for (int i = 0; i < runs; i++) {
+        for (idx_t j = 0; j < cols; j++)
+            x[j] = (double)rand() / RAND_MAX;
+
+        double start = getMilliseconds();
+        csrMatVecMultiply(rows, values, colIndex, rowPtr, x, yRef);
+        double mid = getMilliseconds();
+        csrduMatVecMultiply(D, x, y);
+        double end = getMilliseconds();
+
+        csrTimes[i] = mid - start;
+        times[i] = end - mid;
+        printf("Run %d: %.6f ms   (CSR: %.6f ms)\n", i + 1, times[i], csrTimes[i]);
+        fflush(stdout);
+    }
+
+    // Effective bandwidth: bytes each format has to stream once per SpMV
+    double best = times[0], bestCsr = csrTimes[0];
+    for (int i = 1; i < runs; i++) {
+        if (times[i] < best) best = times[i];
+        if (csrTimes[i] < bestCsr) bestCsr = csrTimes[i];
+    }
+    printf("\nEffective bandwidth (best run):\n");
+    printf("  CSR   : %.6f ms  %.3f GB/s\n", bestCsr, (csrBytes + vecBytes) / (bestCsr * 1e6));
+    printf("  CSR-DU: %.6f ms  %.3f GB/s  (speedup %.3f)\n",
+           best, (duBytes + vecBytes) / (best * 1e6), bestCsr / best);
+    fflush(stdout);
+
+    printf("Saving all %d runs to file...\n", runs);
+    fflush(stdout);
+
+    FILE *fp = fopen("all_runs.txt", "w");
+    if (fp) {
+        fprintf(fp, "All %d runs (in ms) - CSR-DU:\n", runs);
+        for (int i = 0; i < runs; i++) {
+            fprintf(fp, "%.6f\n", times[i]);
+        }
+        fclose(fp);
+        printf("\n=== Success! ===\n");
+        printf("All %d runs saved to all_runs.txt\n", runs);
+        fflush(stdout);
+    } else {
+        printf("Error: could not create output file all_runs.txt\n");
+        fflush(stdout);
+    }
+
+    freeCSRDU(D);
+    free(triplets);
+    free(values);
+    free(colIndex);
+    free(rowPtr);
+    free(x);
+    free(y);
+    free(yRef);
+    free(times);
+    free(csrTimes);
+
+    printf("Program completed successfully.\n");
+    fflush(stdout);
+    return 0;
+}
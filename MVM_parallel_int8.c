@@ -0,0 +1,754 @@
+// Build with -fopenmp (gcc) or /openmp (MSVC)
+// Block-quantized CSR: int8 values with one double scale per row or per
+// block of nonzeros inside a row. rowPtr is the CSR array and only the values
+// are replaced, so a nonzero costs 5 bytes instead of 12. Meant for
+// approximate workloads that tolerate ~1e-3 relative error. One scale per row
+// cannot reach that when a row mixes magnitudes (a large diagonal next to
+// small couplings), so entries above a threshold relative to the row max can
+// move to a side list of float values (8 bytes each) and leave the int8
+// stream; by default the threshold is lowered until the measured error is
+// within -e.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <omp.h>
+#include <inttypes.h>
+#include <limits.h>
+
+// ---------- Index width ----------
+// Two index types: nnz_t counts and addresses nonzeros (rowPtr, nnz), idx_t
+// holds rows and columns (colIndex, triplet indices). Both are 32-bit by
+// default. -DMVM_INDEX64 widens nnz_t only, for matrices with more than
+// 2^31 - 1 nonzeros, so colIndex stays at 4 bytes per nonzero. -DMVM_COL64
+// also widens idx_t, for dimensions beyond 2^31 - 1 (the loader tells you
+// which one a matrix needs).
+#if defined(MVM_INDEX64) || defined(MVM_COL64)
+typedef int64_t nnz_t;
+#define NNZ_FMT "%" PRId64
+#define NNZ_MAX INT64_MAX
+#else
+typedef int nnz_t;
+#define NNZ_FMT "%d"
+#define NNZ_MAX INT_MAX
+#endif
+#ifdef MVM_COL64
+typedef int64_t idx_t;
+#define IDX_FMT "%" PRId64
+#define IDX_SCN "%" SCNd64
+#define IDX_MAX INT64_MAX
+#else
+typedef int idx_t;
+#define IDX_FMT "%d"
+#define IDX_SCN "%d"
+#define IDX_MAX INT_MAX
+#endif
+
+typedef struct {
+    idx_t row;
+    idx_t col;
+    double val;
+} Triplet;
+
+// ---------- Quantized CSR structure ----------
+typedef struct {
+    idx_t rows;
+    idx_t cols;
+    nnz_t nnz;
+    int blockSize;          // nonzeros per scale, 0 = one scale per row
+    nnz_t *rowPtr;          // same row pointer as CSR
+    idx_t *colIndex;        // int8 stream columns; the CSR array itself without a side list
+    int8_t *q;              // quantized values, value ~= scale * q
+    double *scale;          // one scale per block
+    nnz_t *scalePtr;        // first scale of each row, NULL with one scale per row
+    nnz_t *outPtr;          // side list in CSR layout, NULL when empty; row i of the
+                            // int8 stream starts at rowPtr[i] - outPtr[i]
+    idx_t *outCol;
+    float *outVal;          // float error is far below the 1e-3 target and keeps the list small
+} CSRQ8;
+
+// ---------- Quick Sort ----------
+int cmpTriplet(const void *a, const void *b) {
+    const Triplet *ta = (const Triplet *)a;
+    const Triplet *tb = (const Triplet *)b;
+    if (ta->row != tb->row) return (ta->row > tb->row) - (ta->row < tb->row);
+    return (ta->col > tb->col) - (ta->col < tb->col);
+}
+
+// ---------- CSR Conversion ----------
+void convertToCSR(Triplet *triplets, nnz_t nnz, idx_t rows, idx_t cols,
+                  double **values, idx_t **colIndex, nnz_t **rowPtr) {
+    *values = (double *)malloc((size_t)nnz * sizeof(double));
+    *colIndex = (idx_t *)malloc((size_t)nnz * sizeof(idx_t));
+    *rowPtr = (nnz_t *)calloc((size_t)rows + 1, sizeof(nnz_t));
+
+    if (!(*values) || !(*colIndex) || !(*rowPtr)) {
+        printf("Error: memory allocation failed in CSR conversion.\n");
+        fflush(stdout);
+        exit(1);
+    }
+
+    for (nnz_t i = 0; i < nnz; i++) {
+        (*rowPtr)[triplets[i].row + 1]++;
+    }
+    for (idx_t i = 0; i < rows; i++) {
+        (*rowPtr)[i + 1] += (*rowPtr)[i];
+    }
+
+    // We fill from the end of each row bucket, so make a copy of rowPtr to use as write pointers
+    nnz_t *writePtr = (nnz_t *)malloc(((size_t)rows + 1) * sizeof(nnz_t));
+    if (!writePtr) {
+        printf("Error: memory allocation failed in CSR conversion (writePtr).\n");
+        fflush(stdout);
+        exit(1);
+    }
+    for (idx_t i = 0; i <= rows; i++) writePtr[i] = (*rowPtr)[i];
+
+    for (nnz_t i = 0; i < nnz; i++) {
+        idx_t row = triplets[i].row;
+        nnz_t dest = writePtr[row];
+        (*values)[dest] = triplets[i].val;
+        (*colIndex)[dest] = triplets[i].col;
+        writePtr[row]++;
+    }
+
+    free(writePtr);
+}
+
+// ---------- CSR -> int8 Conversion ----------
+// Entries with |v| > outThresh * (row max |v|) go to the side list, so
+// outThresh >= 1 gives none and 0 moves every nonzero there. Every block of
+// the rest takes its scale from its largest magnitude (scale = max|v| / 127)
+// and is rounded to the nearest int8. A first pass counts the side entries,
+// the second fills both lists.
+CSRQ8 *convertToCSRQ8(idx_t rows, idx_t cols, double *values, idx_t *colIndex,
+                      nnz_t *rowPtr, int blockSize, double outThresh) {
+    CSRQ8 *Q = (CSRQ8 *)calloc(1, sizeof(CSRQ8));
+    if (!Q) {
+        printf("Error: memory allocation failed in int8 conversion.\n");
+        fflush(stdout);
+        exit(1);
+    }
+    Q->rows = rows;
+    Q->cols = cols;
+    Q->nnz = rowPtr[rows];
+    Q->blockSize = blockSize;
+    Q->rowPtr = rowPtr;
+    Q->colIndex = colIndex;
+    Q->outPtr = (nnz_t *)calloc((size_t)rows + 1, sizeof(nnz_t));
+    if (!Q->outPtr) {
+        printf("Error: memory allocation failed in int8 conversion.\n");
+        fflush(stdout);
+        exit(1);
+    }
+
+    // Side entries per row
+    if (outThresh < 1.0) {
+        #pragma omp parallel for schedule(static)
+        for (idx_t i = 0; i < rows; i++) {
+            double maxAbs = 0.0;
+            for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+                if (fabs(values[j]) > maxAbs) maxAbs = fabs(values[j]);
+            double cut = outThresh * maxAbs;
+            nnz_t k = 0;
+            for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+                if (fabs(values[j]) > cut) k++;
+            Q->outPtr[i + 1] = k;
+        }
+        for (idx_t i = 0; i < rows; i++) Q->outPtr[i + 1] += Q->outPtr[i];
+    }
+    nnz_t outliers = Q->outPtr[rows];
+    Q->q = (int8_t *)malloc((size_t)(Q->nnz - outliers ? Q->nnz - outliers : 1) * sizeof(int8_t));
+    if (!Q->q) {
+        printf("Error: memory allocation failed in int8 conversion.\n");
+        fflush(stdout);
+        exit(1);
+    }
+    if (outliers == 0) {
+        free(Q->outPtr);
+        Q->outPtr = NULL;
+    } else {
+        Q->colIndex = (idx_t *)malloc((size_t)(Q->nnz - outliers ? Q->nnz - outliers : 1) * sizeof(idx_t));
+        Q->outCol = (idx_t *)malloc((size_t)outliers * sizeof(idx_t));
+        Q->outVal = (float *)malloc((size_t)outliers * sizeof(float));
+        if (!Q->colIndex || !Q->outCol || !Q->outVal) {
+            printf("Error: memory allocation failed in int8 conversion (side list).\n");
+            fflush(stdout);
+            exit(1);
+        }
+    }
+
+    // Scale counts only depend on the int8 row lengths
+    if (blockSize > 0) {
+        Q->scalePtr = (nnz_t *)malloc(((size_t)rows + 1) * sizeof(nnz_t));
+        if (!Q->scalePtr) {
+            printf("Error: memory allocation failed in int8 conversion (scales).\n");
+            fflush(stdout);
+            exit(1);
+        }
+        Q->scalePtr[0] = 0;
+        for (idx_t i = 0; i < rows; i++) {
+            nnz_t len = rowPtr[i + 1] - rowPtr[i];
+            if (Q->outPtr) len -= Q->outPtr[i + 1] - Q->outPtr[i];
+            Q->scalePtr[i + 1] = Q->scalePtr[i] + (len + blockSize - 1) / blockSize;
+        }
+    }
+    nnz_t scales = Q->scalePtr ? Q->scalePtr[rows] : rows;
+    Q->scale = (double *)malloc((size_t)(scales > 0 ? scales : 1) * sizeof(double));
+    if (!Q->scale) {
+        printf("Error: memory allocation failed in int8 conversion (scales).\n");
+        fflush(stdout);
+        exit(1);
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (idx_t i = 0; i < rows; i++) {
+        nnz_t start = rowPtr[i], end = rowPtr[i + 1];
+        nnz_t qStart = start, qEnd = end;
+        double cut = HUGE_VAL; // entries above it are the side entries of the row
+        if (Q->outPtr) {
+            qStart -= Q->outPtr[i];
+            qEnd -= Q->outPtr[i + 1];
+            if (Q->outPtr[i + 1] > Q->outPtr[i]) {
+                double maxAbs = 0.0;
+                for (nnz_t j = start; j < end; j++)
+                    if (fabs(values[j]) > maxAbs) maxAbs = fabs(values[j]);
+                cut = outThresh * maxAbs;
+            }
+            nnz_t o = Q->outPtr[i], p = qStart;
+            for (nnz_t j = start; j < end; j++) {
+                if (fabs(values[j]) > cut) {
+                    Q->outCol[o] = colIndex[j];
+                    Q->outVal[o++] = (float)values[j];
+                } else {
+                    Q->colIndex[p++] = colIndex[j];
+                }
+            }
+        }
+        double *sc = Q->scale + (Q->scalePtr ? Q->scalePtr[i] : i);
+        if (qEnd == qStart && !Q->scalePtr) *sc = 0.0;
+        nnz_t step = (blockSize > 0) ? blockSize : (qEnd - qStart);
+        nnz_t j = start; // walks the CSR row, skipping the side entries
+        for (nnz_t b = qStart; b < qEnd; b += step, sc++) {
+            nnz_t e = (b + step < qEnd) ? b + step : qEnd;
+            nnz_t j0 = j;
+            double maxAbs = 0.0;
+            for (nnz_t p = b; p < e; j++) {
+                if (fabs(values[j]) > cut) continue;
+                if (fabs(values[j]) > maxAbs) maxAbs = fabs(values[j]);
+                p++;
+            }
+            double s = maxAbs / 127.0;
+            double inv = (s > 0.0) ? 1.0 / s : 0.0;
+            *sc = s;
+            for (nnz_t p = b, k = j0; p < e; k++) {
+                if (fabs(values[k]) > cut) continue;
+                Q->q[p++] = (int8_t)lrint(values[k] * inv);
+            }
+        }
+    }
+
+    return Q;
+}
+
+void freeCSRQ8(CSRQ8 *Q) {
+    if (Q->outPtr) free(Q->colIndex); // otherwise the CSR array
+    free(Q->q);
+    free(Q->scale);
+    free(Q->scalePtr);
+    free(Q->outPtr);
+    free(Q->outCol);
+    free(Q->outVal);
+    free(Q);
+}
+
+// ---------- Matrix-Vector Multiplication (CSR, parallelized with OpenMP) ----------
+void csrMatVecMultiply(idx_t rows, double *values, idx_t *colIndex, nnz_t *rowPtr,
+                       double *x, double *y) {
+    // Each row is independent so we parallelize over rows.
+    #pragma omp parallel for schedule(runtime)
+    for (idx_t i = 0; i < rows; i++) {
+        double sum = 0.0;
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++) {
+            sum += values[j] * x[colIndex[j]];
+        }
+        y[i] = sum;
+    }
+}
+
+// ---------- Matrix-Vector Multiplication (int8 values) ----------
+// The int8 values are widened in registers; the scale is applied once per
+// block to the partial sum. Plain scalar loops: rows are short, and an
+// omp simd gather loop measured slower than this on every repo matrix.
+static inline double q8Dot(const int8_t *q, const idx_t *colIndex, const double *x, nnz_t b, nnz_t e) {
+    double part = 0.0;
+    for (nnz_t j = b; j < e; j++)
+        part += (double)q[j] * x[colIndex[j]];
+    return part;
+}
+
+void csrq8MatVecMultiply(const CSRQ8 *Q, const double *x, double *y) {
+    const nnz_t *rowPtr = Q->rowPtr;
+    const nnz_t *outPtr = Q->outPtr;
+    const idx_t *colIndex = Q->colIndex;
+    const int8_t *q = Q->q;
+    const double *scale = Q->scale;
+    nnz_t blockSize = Q->blockSize;
+
+    #pragma omp parallel for schedule(runtime)
+    for (idx_t i = 0; i < Q->rows; i++) {
+        nnz_t start = rowPtr[i], end = rowPtr[i + 1], o0 = 0, o1 = 0;
+        if (outPtr) {
+            o0 = outPtr[i];
+            o1 = outPtr[i + 1];
+            start -= o0;
+            end -= o1;
+        }
+        double sum;
+        if (!Q->scalePtr) {
+            sum = scale[i] * q8Dot(q, colIndex, x, start, end);
+        } else {
+            const double *sc = scale + Q->scalePtr[i];
+            sum = 0.0;
+            for (nnz_t b = start; b < end; b += blockSize, sc++)
+                sum += *sc * q8Dot(q, colIndex, x, b, (b + blockSize < end) ? b + blockSize : end);
+        }
+        for (nnz_t j = o0; j < o1; j++)
+            sum += (double)Q->outVal[j] * x[Q->outCol[j]];
+        y[i] = sum;
+    }
+}
+
+// Side entries in the quantized matrix
+nnz_t csrq8Outliers(const CSRQ8 *Q) {
+    return Q->outPtr ? Q->outPtr[Q->rows] : 0;
+}
+
+// Scales in the quantized matrix
+nnz_t csrq8Scales(const CSRQ8 *Q) {
+    return Q->scalePtr ? Q->scalePtr[Q->rows] : Q->rows;
+}
+
+// int8 values + colIndex + rowPtr + scales (+ scalePtr) (+ side list)
+double csrq8Bytes(const CSRQ8 *Q) {
+    nnz_t outliers = csrq8Outliers(Q);
+    double bytes = (double)(Q->nnz - outliers) * (sizeof(int8_t) + sizeof(idx_t))
+                 + (double)(Q->rows + 1) * sizeof(nnz_t) + (double)csrq8Scales(Q) * sizeof(double);
+    if (Q->scalePtr) bytes += (double)(Q->rows + 1) * sizeof(nnz_t);
+    if (Q->outPtr)
+        bytes += (double)outliers * (sizeof(float) + sizeof(idx_t)) + (double)(Q->rows + 1) * sizeof(nnz_t);
+    return bytes;
+}
+
+// Max |y_q - y| relative to ||y||_inf over a few random x vectors
+double quantizationError(const CSRQ8 *Q, double *values, idx_t *colIndex, double *x, double *y,
+                         double *yRef, int samples) {
+    double maxErr = 0.0;
+    for (int s = 0; s < samples; s++) {
+        for (idx_t j = 0; j < Q->cols; j++)
+            x[j] = (double)rand() / RAND_MAX;
+        csrMatVecMultiply(Q->rows, values, colIndex, Q->rowPtr, x, yRef);
+        csrq8MatVecMultiply(Q, x, y);
+        double diff = 0.0, norm = 0.0;
+        for (idx_t i = 0; i < Q->rows; i++) {
+            if (fabs(y[i] - yRef[i]) > diff) diff = fabs(y[i] - yRef[i]);
+            if (fabs(yRef[i]) > norm) norm = fabs(yRef[i]);
+        }
+        double err = (norm > 0.0) ? diff / norm : diff;
+        if (err > maxErr) maxErr = err;
+    }
+    return maxErr;
+}
+
+// ---------- Time in milliseconds ----------
+double getMilliseconds() {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);  // get current time in UTC
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6; // convert to milliseconds
+}
+
+// ---------- Command-line utilities ----------
+void printUsage(const char *prog) {
+    printf("Usage: %s <matrix_file> [-r runs] [-t threads] [-s schedule] [-c chunk] [-b block] [-e tol] [-o frac]\n", prog);
+    printf("  -r runs      : number of runs (default 10)\n");
+    printf("  -t threads   : number of OpenMP threads (default = hardware)\n");
+    printf("  -s schedule  : schedule: static | dynamic | guided | auto (default guided)\n");
+    printf("  -c chunk     : chunk size for schedule (integer, default 0)\n");
+    printf("  -b block     : nonzeros per scale inside a row, 0 = one scale per row,\n"
+           "                 auto = smallest of 0, 32, 16, 8, 4 within -e (default auto)\n");
+    printf("  -e tol       : acceptable relative error (default 1e-3)\n");
+    printf("  -o thresh    : entries above thresh * row max go to the float side list,\n"
+           "                 1 = none, auto = 1, 1/2, ..., 1/128, 0 (default auto)\n");
+    printf("Example: %s matrix.txt -r 20 -t 8 -s guided -c 16 -b 16\n", prog);
+}
+
+// Map schedule string to omp_sched_t
+int parseSchedule(const char *s, omp_sched_t *outKind) {
+    if (!s) return 0;
+    if (strcmp(s, "static") == 0) { *outKind = omp_sched_static; return 1; }
+    if (strcmp(s, "dynamic") == 0) { *outKind = omp_sched_dynamic; return 1; }
+    if (strcmp(s, "guided") == 0) { *outKind = omp_sched_guided; return 1; }
+    if (strcmp(s, "auto") == 0)   { *outKind = omp_sched_auto;   return 1; }
+    return 0;
+}
+
+// ---------- Main ----------
+int main(int argc, char *argv[]) {
+    printf("=== Sparse Matrix Program (int8 values) Starting ===\n");
+    fflush(stdout);
+
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Defaults
+    char *filename = argv[1];
+    int runs = 10;
+    int threads = 0; // 0 means leave to OpenMP default/hardware
+    const char *schedStr = "guided";
+    int chunk = 0;
+    int blockSize = -1; // -1 = auto
+    double tol = 1e-3;
+    double outThresh = -1.0; // -1 = auto
+
+    // Parse optional args
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+            if (runs <= 0) runs = 10;
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+            if (threads < 0) threads = 0;
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            schedStr = argv[++i];
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            chunk = atoi(argv[++i]);
+            if (chunk < 0) chunk = 0;
+        } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            i++;
+            blockSize = (strcmp(argv[i], "auto") == 0) ? -1 : atoi(argv[i]);
+            if (blockSize < -1) blockSize = -1;
+        } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            tol = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            i++;
+            outThresh = (strcmp(argv[i], "auto") == 0) ? -1.0 : atof(argv[i]);
+            if (outThresh > 1.0) outThresh = 1.0;
+            if (outThresh < 0.0) outThresh = -1.0;
+        } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            printf("Unknown option: %s\n", argv[i]);
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    printf("Attempting to open file: %s\n", filename);
+    fflush(stdout);
+
+    FILE *fin = fopen(filename, "r");
+    if (!fin) {
+        printf("Error: cannot open file '%s'\n", filename);
+        fflush(stdout);
+        return 1;
+    }
+
+    printf("File opened successfully!\n");
+    fflush(stdout);
+
+    // Skip all comment lines starting with %
+    int comment_count = 0;
+    int ch;
+    while ((ch = fgetc(fin)) != EOF) {
+        if (ch == '%') {
+            while ((ch = fgetc(fin)) != EOF && ch != '\n');
+            comment_count++;
+        } else {
+            ungetc(ch, fin);
+            break;
+        }
+    }
+
+    printf("Skipped %d comment line(s).\n", comment_count);
+    fflush(stdout);
+
+    if (ch == EOF) {
+        printf("Error: file contains only comments or is empty.\n");
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+
+    printf("Reading matrix header...\n");
+    fflush(stdout);
+
+    long long hdrRows, hdrCols, hdrNnz;
+    if (fscanf(fin, "%lld %lld %lld", &hdrRows, &hdrCols, &hdrNnz) != 3) {
+        printf("Error: invalid matrix header.\n");
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+
+    printf("Matrix dimensions: %lld x %lld with %lld non-zero elements\n", hdrRows, hdrCols, hdrNnz);
+    fflush(stdout);
+
+    if (hdrRows <= 0 || hdrCols <= 0 || hdrNnz <= 0) {
+        printf("Error: invalid matrix dimensions (must be positive).\n");
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+    if (hdrNnz > NNZ_MAX) {
+        printf("Error: %lld nonzeros do not fit in %d-bit offsets, rebuild with -DMVM_INDEX64.\n",
+               hdrNnz, (int)(8 * sizeof(nnz_t)));
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+    if (hdrRows > IDX_MAX || hdrCols > IDX_MAX) {
+        printf("Error: matrix dimensions do not fit in %d-bit indices, rebuild with -DMVM_COL64.\n",
+               (int)(8 * sizeof(idx_t)));
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+    idx_t rows = (idx_t)hdrRows, cols = (idx_t)hdrCols;
+    nnz_t nnz = (nnz_t)hdrNnz;
+
+    Triplet *triplets = (Triplet *)malloc((size_t)nnz * sizeof(Triplet));
+    if (!triplets) {
+        printf("Error: memory allocation failed for triplets.\n");
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+
+    printf("Reading matrix elements...\n");
+    fflush(stdout);
+
+    idx_t maxRow = 0, maxCol = 0;
+
+    for (nnz_t i = 0; i < nnz; i++) {
+        if (fscanf(fin, IDX_SCN " " IDX_SCN " %lf", &triplets[i].row, &triplets[i].col, &triplets[i].val) != 3) {
+            printf("Error: invalid matrix element at entry " NNZ_FMT ".\n", i + 1);
+            fflush(stdout);
+            fclose(fin);
+            free(triplets);
+            return 1;
+        }
+        if (triplets[i].row > maxRow) maxRow = triplets[i].row;
+        if (triplets[i].col > maxCol) maxCol = triplets[i].col;
+    }
+
+    // If indices are 1-based, subtract 1 from all
+    if (maxRow == rows || maxCol == cols) {
+        printf("Detected 1-based indexing, converting to 0-based...\n");
+        fflush(stdout);
+        for (nnz_t i = 0; i < nnz; i++) {
+            triplets[i].row--;
+            triplets[i].col--;
+        }
+    }
+
+    // Validate indices
+    for (nnz_t i = 0; i < nnz; i++) {
+        if (triplets[i].row < 0 || triplets[i].row >= rows ||
+            triplets[i].col < 0 || triplets[i].col >= cols) {
+            printf("Error: invalid indices at entry " NNZ_FMT " (row=" IDX_FMT ", col=" IDX_FMT ")\n",
+                   i + 1, triplets[i].row, triplets[i].col);
+            fflush(stdout);
+            fclose(fin);
+            free(triplets);
+            return 1;
+        }
+    }
+    fclose(fin);
+    printf("Matrix data loaded successfully!\n");
+    fflush(stdout);
+
+    printf("Sorting triplets using qsort...\n");
+    fflush(stdout);
+    qsort(triplets, (size_t)nnz, sizeof(Triplet), cmpTriplet);
+
+    printf("Converting to CSR format...\n");
+    fflush(stdout);
+    double *values;
+    idx_t *colIndex;
+    nnz_t *rowPtr;
+    convertToCSR(triplets, nnz, rows, cols, &values, &colIndex, &rowPtr);
+
+    printf("Allocating vectors...\n");
+    fflush(stdout);
+    double *x = (double *)malloc((size_t)cols * sizeof(double));
+    double *y = (double *)malloc((size_t)rows * sizeof(double));
+    double *yRef = (double *)malloc((size_t)rows * sizeof(double));
+    double *times = (double *)malloc(runs * sizeof(double));
+    double *csrTimes = (double *)malloc(runs * sizeof(double));
+    if (!x || !y || !yRef || !times || !csrTimes) {
+        printf("Error: memory allocation failed for vectors.\n");
+        fflush(stdout);
+        return 1;
+    }
+
+    // Configure OpenMP runtime scheduling based on user input
+    omp_sched_t schedKind;
+    if (!parseSchedule(schedStr, &schedKind)) {
+        printf("Unknown schedule '%s'. Valid: static, dynamic, guided, auto\n", schedStr);
+        return 1;
+    }
+
+    if (threads > 0) {
+        omp_set_num_threads(threads);
+    }
+    omp_set_schedule(schedKind, chunk);
+    // Every error measurement uses the same x vectors, so the search and the
+    // final report agree
+    unsigned int errSeed = (unsigned int)time(NULL);
+    srand(errSeed);
+
+    // Settings not fixed on the command line are searched: every combination
+    // of scale block and side-list threshold is converted and its error
+    // measured, and the smallest matrix within -e is kept (the smallest error
+    // if none is). Threshold 0 keeps every value as float, 8 bytes per nonzero.
+    static const int blocks[] = {0, 32, 16, 8, 4};
+    static const double threshs[] = {1.0, 1.0 / 2, 1.0 / 4, 1.0 / 8, 1.0 / 16, 1.0 / 32, 1.0 / 64, 1.0 / 128, 0.0};
+    int nBlocks = (blockSize < 0) ? (int)(sizeof(blocks) / sizeof(blocks[0])) : 1;
+    int nThreshs = (outThresh < 0.0) ? (int)(sizeof(threshs) / sizeof(threshs[0])) : 1;
+    if (nBlocks * nThreshs > 1) {
+        printf("Searching int8 settings for max relative error %.1e...\n", tol);
+        fflush(stdout);
+        int bestBlock = 0, tried = 0, within = 0;
+        double bestThresh = 1.0, bestBytes = 0.0, bestErr = 0.0;
+        for (int b = 0; b < nBlocks; b++) {
+            for (int f = 0; f < nThreshs; f++) {
+                int blk = (blockSize < 0) ? blocks[b] : blockSize;
+                double thresh = (outThresh < 0.0) ? threshs[f] : outThresh;
+                CSRQ8 *T = convertToCSRQ8(rows, cols, values, colIndex, rowPtr, blk, thresh);
+                srand(errSeed);
+                double e = quantizationError(T, values, colIndex, x, y, yRef, 3);
+                double bytes = csrq8Bytes(T);
+                freeCSRQ8(T);
+                tried++;
+                int ok = e <= tol, bestOk = bestErr <= tol;
+                if (ok) within++;
+                // A setting within tolerance beats one above it; then fewer bytes, or lower error
+                if (tried == 1 || (ok && !bestOk) || (ok && bytes < bestBytes) || (!ok && !bestOk && e < bestErr)) {
+                    bestBlock = blk;
+                    bestThresh = thresh;
+                    bestBytes = bytes;
+                    bestErr = e;
+                }
+                if (ok) break; // lower thresholds only add bytes
+            }
+        }
+        printf("  %d of %d settings within tolerance, chosen: block %d, side-list threshold %.4f of the row max\n",
+               within, tried, bestBlock, bestThresh);
+        fflush(stdout);
+        blockSize = bestBlock;
+        outThresh = bestThresh;
+    }
+
+    if (blockSize > 0)
+        printf("Quantizing values to int8 (one scale per %d nonzeros)...\n", blockSize);
+    else
+        printf("Quantizing values to int8 (one scale per row)...\n");
+    fflush(stdout);
+    double convStart = getMilliseconds();
+    CSRQ8 *Q = convertToCSRQ8(rows, cols, values, colIndex, rowPtr, blockSize, outThresh);
+    double convEnd = getMilliseconds();
+    srand(errSeed);
+    double err = quantizationError(Q, values, colIndex, x, y, yRef, 3);
+
+    nnz_t scales = csrq8Scales(Q);
+    nnz_t outliers = csrq8Outliers(Q);
+    double csrBytes = (double)nnz * (sizeof(double) + sizeof(idx_t)) + (double)(rows + 1) * sizeof(nnz_t);
+    double q8Bytes = csrq8Bytes(Q);
+    printf("\nint8 storage:\n");
+    printf("  Conversion time: %.6f ms\n", convEnd - convStart);
+    printf("  Scales: " NNZ_FMT "\n", scales);
+    printf("  Side list (float): " NNZ_FMT " entries (%.2f%% of nonzeros)\n", outliers, 100.0 * outliers / nnz);
+    printf("  Matrix bytes CSR: %.0f  int8: %.0f  (compression ratio %.3f)\n",
+           csrBytes, q8Bytes, csrBytes / q8Bytes);
+    if (q8Bytes >= csrBytes)
+        printf("  Warning: no int8 setting within the tolerance is smaller than CSR for this matrix.\n");
+    fflush(stdout);
+
+    int usedThreads = omp_get_max_threads();
+    printf("\nRuntime configuration:\n");
+    printf("  Runs: %d\n", runs);
+    printf("  Threads (omp_get_max_threads): %d\n", usedThreads);
+    printf("  Schedule: %s  chunk=%d\n", schedStr, chunk);
+    printf("  Scale block: %d\n", blockSize);
+    fflush(stdout);
+
+    printf("Max relative error vs csrMatVecMultiply (3 random x, ||.||_inf): %.3e  [%s tolerance %.1e]\n",
+           err, err <= tol ? "within" : "ABOVE", tol);
+    fflush(stdout);
+
+    printf("\nRunning %d matrix-vector multiplications (int8, CSR reference)...\n", runs);
+    fflush(stdout);
+
+    for (int i = 0; i < runs; i++) {
+        for (idx_t j = 0; j < cols; j++)
+            x[j] = (double)rand() / RAND_MAX;
+
+        double start = getMilliseconds();
+        csrMatVecMultiply(rows, values, colIndex, rowPtr, x, yRef);
+        double mid = getMilliseconds();
+        csrq8MatVecMultiply(Q, x, y);
+        double end = getMilliseconds();
+
+        csrTimes[i] = mid - start;
+        times[i] = end - mid;
+        printf("Run %d: %.6f ms   (CSR: %.6f ms)\n", i + 1, times[i], csrTimes[i]);
+        fflush(stdout);
+    }
+
+    double best = times[0], bestCsr = csrTimes[0];
+    for (int i = 1; i < runs; i++) {
+        if (times[i] < best) best = times[i];
+        if (csrTimes[i] < bestCsr) bestCsr = csrTimes[i];
+    }
+    printf("\nBest run: CSR %.6f ms, int8 %.6f ms (speedup %.3f)\n", bestCsr, best, bestCsr / best);
+    fflush(stdout);
+
+    printf("Saving all %d runs to file...\n", runs);
+    fflush(stdout);
+
+    FILE *fp = fopen("all_runs.txt", "w");
+    if (fp) {
+        fprintf(fp, "All %d runs (in ms) - int8 values:\n", runs);
+        for (int i = 0; i < runs; i++) {
+            fprintf(fp, "%.6f\n", times[i]);
+        }
+        fclose(fp);
+        printf("\n=== Success! ===\n");
+        printf("All %d runs saved to all_runs.txt\n", runs);
+        fflush(stdout);
+    } else {
+        printf("Error: could not create output file all_runs.txt\n");
+        fflush(stdout);
+    }
+
+    freeCSRQ8(Q);
+    free(triplets);
+    free(values);
+    free(colIndex);
+    free(rowPtr);
+    free(x);
+    free(y);
+    free(yRef);
+    free(times);
+    free(csrTimes);
+
+    printf("Program completed successfully.\n");
+    fflush(stdout);
+    return 0;
+}
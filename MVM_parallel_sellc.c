@@ -1,27 +1,65 @@
 // ================================================================
 // Modern SELL-C-σ SpMV (fully standalone, no wrapper needed)
-// Flags order: -r <runs> -c <chunk> -s <sigma> -t <threads>
+// Flags order: -r <runs> -c <chunk> -s <sigma> -t <threads> [-p <precision>]
 // ================================================================
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <math.h>
 #include <omp.h>
 #include <time.h>
+#include <inttypes.h>
+#include <limits.h>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// ------------------- Index width ---------------------------
+// nnz_t addresses nonzeros (slice_ptr, CSR rowptr, nnz), idx_t holds rows and
+// columns (col_idx, perm). Both are 32-bit by default. -DMVM_INDEX64 widens
+// nnz_t only, for nnz (including the SELL padding) beyond 2^31 - 1, so col_idx
+// keeps 4 bytes per entry; -DMVM_COL64 also widens idx_t for larger dimensions.
+#if defined(MVM_INDEX64) || defined(MVM_COL64)
+typedef int64_t nnz_t;
+#define NNZ_FMT "%" PRId64
+#define NNZ_MAX INT64_MAX
+#else
+typedef int nnz_t;
+#define NNZ_FMT "%d"
+#define NNZ_MAX INT_MAX
+#endif
+#ifdef MVM_COL64
+typedef int64_t idx_t;
+#define IDX_FMT "%" PRId64
+#define IDX_SCN "%" SCNd64
+#define IDX_MAX INT64_MAX
+#else
+typedef int idx_t;
+#define IDX_FMT "%d"
+#define IDX_SCN "%d"
+#define IDX_MAX INT_MAX
+#endif
 
 // ------------------- SELL-C-σ structure -------------------
 typedef struct {
     int C;                // chunk height
     int sigma;            // sort block size
-    int rows;
-    int cols;
-    int slices;
-    int *slice_ptr;
-    int *col_idx;
+    idx_t rows;
+    idx_t cols;
+    idx_t slices;
+    nnz_t *slice_ptr;
+    idx_t *col_idx;
     double *values;
-    int *slice_lengths;
+    idx_t *slice_lengths;
+    idx_t *perm;            // sorted position -> original row
+    float *values_f;      // optional float copy of values
+    uint16_t *values_h;   // optional bfloat16 copy of values
 } SELL_CS;
 
+enum { PREC_DOUBLE, PREC_FLOAT, PREC_BF16 };
+
 // ------------------- Timing utility ------------------------
 double get_ms() {
     struct timespec ts;
@@ -29,61 +67,192 @@ double get_ms() {
     return ts.tv_sec*1000.0 + ts.tv_nsec/1e6;
 }
 
+// ------------------- Arena allocator ----------------------
+// The COO/CSR/SELL arrays and x/y are 64-byte aligned slices of large regions:
+// MAP_HUGETLB if the system has huge pages reserved, otherwise a 2 MiB aligned
+// mapping with madvise(MADV_HUGEPAGE); a malloc'd block off Linux. A new region
+// is mapped when the current one is full, all are released at the end.
+#define ARENA_ALIGN 64
+#define HUGE_PAGE ((size_t)2<<20)
+#define ARENA_REGION ((size_t)32<<20)   // minimum region size
+#define ARENA_MAX_REGIONS 64
+enum { ARENA_HUGETLB, ARENA_THP, ARENA_MALLOC };
+
+typedef struct {
+    char *base; void *raw; size_t raw_size;
+    size_t size, used;
+    int kind;
+} arena_region;
+
+static arena_region arena[ARENA_MAX_REGIONS];
+static int arena_count = 0;
+static size_t arena_overflow = 0;   // bytes that went to plain malloc
+
+static int arena_map(arena_region *r, size_t bytes){
+    bytes=(bytes+HUGE_PAGE-1)/HUGE_PAGE*HUGE_PAGE;
+    r->size=bytes; r->used=0;
+#if defined(__linux__)
+#ifdef MAP_HUGETLB
+    void *p=mmap(NULL,bytes,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB,-1,0);
+    if(p!=MAP_FAILED){ r->raw=r->base=p; r->raw_size=bytes; r->kind=ARENA_HUGETLB; return 1; }
+#endif
+    void *q=mmap(NULL,bytes+HUGE_PAGE,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+    if(q!=MAP_FAILED){
+        r->raw=q; r->raw_size=bytes+HUGE_PAGE;
+        r->base=(char*)(((uintptr_t)q+HUGE_PAGE-1)&~(uintptr_t)(HUGE_PAGE-1));
+#ifdef MADV_HUGEPAGE
+        madvise(r->base,bytes,MADV_HUGEPAGE);
+#endif
+        r->kind=ARENA_THP; return 1;
+    }
+#endif
+    r->raw=malloc(bytes+ARENA_ALIGN);
+    if(!r->raw) return 0;
+    r->raw_size=bytes+ARENA_ALIGN;
+    r->base=(char*)(((uintptr_t)r->raw+ARENA_ALIGN-1)&~(uintptr_t)(ARENA_ALIGN-1));
+    r->kind=ARENA_MALLOC; return 1;
+}
+
+void *arena_alloc(size_t bytes){
+    size_t need=(bytes+ARENA_ALIGN-1)&~(size_t)(ARENA_ALIGN-1);
+    if(need==0) need=ARENA_ALIGN;
+    arena_region *r = arena_count ? &arena[arena_count-1] : NULL;
+    if(!r || r->size-r->used<need){
+        r=NULL;
+        if(arena_count<ARENA_MAX_REGIONS && arena_map(&arena[arena_count],need>ARENA_REGION?need:ARENA_REGION))
+            r=&arena[arena_count++];
+    }
+    if(!r){ arena_overflow+=bytes; return malloc(bytes?bytes:1); }
+    void *p=r->base+r->used;
+    r->used+=need;
+    return p;
+}
+
+// free() for pointers that may be arena slices
+void arena_free(void *p){
+    if(!p) return;
+    for(int i=0;i<arena_count;i++)
+        if((char*)p>=arena[i].base && (char*)p<arena[i].base+arena[i].size) return;
+    free(p);
+}
+
+void arena_release(void){
+    for(int i=0;i<arena_count;i++){
+#if defined(__linux__)
+        if(arena[i].kind!=ARENA_MALLOC){ munmap(arena[i].raw,arena[i].raw_size); continue; }
+#endif
+        free(arena[i].raw);
+    }
+    arena_count=0; arena_overflow=0;
+}
+
+// huge-page share of the resident arena memory (Rss/AnonHugePages from /proc/self/smaps)
+void arena_report(void){
+    static const char *kinds[]={"MAP_HUGETLB","madvise(MADV_HUGEPAGE)","malloc"};
+    size_t used=0, mapped=0;
+    double resident_kb=0.0, huge_kb=0.0;
+    for(int i=0;i<arena_count;i++){
+        used+=arena[i].used; mapped+=arena[i].size;
+        if(arena[i].kind==ARENA_HUGETLB){
+            size_t touched=(arena[i].used+HUGE_PAGE-1)/HUGE_PAGE*HUGE_PAGE;
+            resident_kb+=touched/1024.0; huge_kb+=touched/1024.0;
+        }
+    }
+#if defined(__linux__)
+    FILE *f=fopen("/proc/self/smaps","r");
+    if(f){
+        char line[256]; int inside=0;
+        uintptr_t lo,hi;
+        while(fgets(line,sizeof(line),f)){
+            if(sscanf(line,"%" SCNxPTR "-%" SCNxPTR,&lo,&hi)==2){   // mapping header line
+                inside=0;
+                for(int i=0;i<arena_count;i++)
+                    if(arena[i].kind==ARENA_THP && (uintptr_t)arena[i].base>=lo && (uintptr_t)arena[i].base<hi) inside=1;
+                continue;
+            }
+            if(!inside) continue;
+            if(strncmp(line,"Rss:",4)==0) resident_kb+=atof(line+4);
+            else if(strncmp(line,"AnonHugePages:",14)==0) huge_kb+=atof(line+14);
+        }
+        fclose(f);
+    }
+#endif
+    printf("Arena: %d region(s) (%s), %.1f MiB used of %.1f MiB mapped, %.1f MiB outside the arena\n",
+           arena_count,arena_count?kinds[arena[0].kind]:"none",used/1048576.0,mapped/1048576.0,arena_overflow/1048576.0);
+    if(resident_kb>0.0)
+        printf("  Huge-page coverage: %.1f%% of %.1f MiB resident\n",100.0*huge_kb/resident_kb,resident_kb/1024.0);
+    else
+        printf("  Huge-page coverage: unknown (no /proc/self/smaps) or 4 KiB pages only\n");
+}
+
 // ------------------- CSR → SELL-C-σ ------------------------
-SELL_CS *csr_to_sellcs(int rows, int cols, int nnz,
-                       double *csr_val, int *csr_col, int *csr_rowptr,
+SELL_CS *csr_to_sellcs(idx_t rows, idx_t cols, nnz_t nnz,
+                       double *csr_val, idx_t *csr_col, nnz_t *csr_rowptr,
                        int C, int sigma)
 {
     SELL_CS *S = calloc(1,sizeof(*S));
     S->C = C; S->sigma = sigma; S->rows = rows; S->cols = cols;
     S->slices = (rows + C - 1)/C;
-    S->slice_ptr = calloc(S->slices + 1, sizeof(int));
-    S->slice_lengths = calloc(S->slices, sizeof(int));
+    S->slice_ptr = arena_alloc(((size_t)S->slices + 1)*sizeof(nnz_t));
+    S->slice_lengths = arena_alloc((size_t)S->slices*sizeof(idx_t));
+    S->slice_ptr[0] = 0;
 
-    int *row_len = malloc(rows*sizeof(int));
-    for(int i=0;i<rows;i++) row_len[i] = csr_rowptr[i+1]-csr_rowptr[i];
+    S->perm = arena_alloc((size_t)rows*sizeof(idx_t));
+    idx_t *row_len = malloc((size_t)rows*sizeof(idx_t));
+    for(idx_t i=0;i<rows;i++){ row_len[i] = (idx_t)(csr_rowptr[i+1]-csr_rowptr[i]); S->perm[i]=i; }
 
-    // sort in blocks of sigma
-    for(int b=0;b<rows;b+=sigma) {
-        int end = b+sigma < rows ? b+sigma : rows;
-        for(int i=b;i<end;i++)
-            for(int j=i+1;j<end;j++)
+    // sort in blocks of sigma; perm keeps the original row of each sorted position
+    for(idx_t b=0;b<rows;b+=sigma) {
+        idx_t end = b+sigma < rows ? b+sigma : rows;
+        for(idx_t i=b;i<end;i++)
+            for(idx_t j=i+1;j<end;j++)
                 if(row_len[j]>row_len[i]){
-                    int tmp=row_len[i]; row_len[i]=row_len[j]; row_len[j]=tmp;
+                    idx_t tmp=row_len[i]; row_len[i]=row_len[j]; row_len[j]=tmp;
+                    tmp=S->perm[i]; S->perm[i]=S->perm[j]; S->perm[j]=tmp;
                 }
     }
 
     // slice lengths
-    for(int s=0;s<S->slices;s++){
-        int start = s*C;
-        int end = (start+C<rows?start+C:rows);
-        int max_len=0;
-        for(int r=start;r<end;r++) if(row_len[r]>max_len) max_len=row_len[r];
+    for(idx_t s=0;s<S->slices;s++){
+        idx_t start = s*C;
+        idx_t end = (start+C<rows?start+C:rows);
+        idx_t max_len=0;
+        for(idx_t r=start;r<end;r++) if(row_len[r]>max_len) max_len=row_len[r];
         S->slice_lengths[s] = max_len;
     }
 
-    // slice_ptr prefix sum
-    for(int s=0;s<S->slices;s++)
-        S->slice_ptr[s+1] = S->slice_ptr[s] + S->slice_lengths[s]*C;
+    // slice_ptr prefix sum; the padding can push it past the index width even when nnz fits
+    int64_t padded = 0;
+    for(idx_t s=0;s<S->slices;s++){
+        padded += (int64_t)S->slice_lengths[s]*C;
+        if(padded > NNZ_MAX){
+            printf("Error: padded SELL-C size does not fit in %d-bit offsets, rebuild with -DMVM_INDEX64.\n",
+                   (int)(8*sizeof(nnz_t)));
+            free(row_len); arena_free(S->slice_ptr); arena_free(S->slice_lengths); arena_free(S->perm); free(S);
+            return NULL;
+        }
+        S->slice_ptr[s+1] = (nnz_t)padded;
+    }
 
-    int total_nnz_sell = S->slice_ptr[S->slices];
-    S->col_idx = malloc(total_nnz_sell*sizeof(int));
-    S->values  = malloc(total_nnz_sell*sizeof(double));
+    nnz_t total_nnz_sell = S->slice_ptr[S->slices];
+    S->col_idx = arena_alloc((size_t)total_nnz_sell*sizeof(idx_t));
+    S->values  = arena_alloc((size_t)total_nnz_sell*sizeof(double));
 
-    for(int s=0;s<S->slices;s++){
-        int start=s*C, end=(start+C<rows?start+C:rows);
-        int slice_len = S->slice_lengths[s];
-        int base = S->slice_ptr[s];
-        for(int r=start;r<end;r++){
-            int csr_start = csr_rowptr[r], csr_end = csr_rowptr[r+1], row_nnz = csr_end - csr_start;
-            int k=0;
-            for(int j=csr_start;j<csr_end;j++,k++){
-                S->values[base + k*C + (r-start)] = csr_val[j];
-                S->col_idx[base + k*C + (r-start)] = csr_col[j];
+    for(idx_t s=0;s<S->slices;s++){
+        idx_t start=s*C, end=(start+C<rows?start+C:rows);
+        idx_t slice_len = S->slice_lengths[s];
+        nnz_t base = S->slice_ptr[s];
+        for(idx_t r=start;r<end;r++){
+            idx_t orig = S->perm[r];
+            nnz_t csr_start = csr_rowptr[orig], csr_end = csr_rowptr[orig+1];
+            idx_t k=0;
+            for(nnz_t j=csr_start;j<csr_end;j++,k++){
+                S->values[base + (nnz_t)k*C + (r-start)] = csr_val[j];
+                S->col_idx[base + (nnz_t)k*C + (r-start)] = csr_col[j];
             }
             for(;k<slice_len;k++){
-                S->values[base + k*C + (r-start)] = 0.0;
-                S->col_idx[base + k*C + (r-start)] = 0;
+                S->values[base + (nnz_t)k*C + (r-start)] = 0.0;
+                S->col_idx[base + (nnz_t)k*C + (r-start)] = 0;
             }
         }
     }
@@ -96,26 +265,566 @@ SELL_CS *csr_to_sellcs(int rows, int cols, int nnz,
 void sellcs_spmv(const SELL_CS *S, const double *x, double *y){
     int C=S->C;
 #pragma omp parallel for schedule(runtime)
-    for(int r=0;r<S->rows;r++) y[r]=0.0;
+    for(idx_t r=0;r<S->rows;r++) y[r]=0.0;
+
+#pragma omp parallel for schedule(runtime)
+    for(idx_t s=0;s<S->slices;s++){
+        idx_t start=s*C, end=(start+C<S->rows?start+C:S->rows);
+        idx_t slice_len=S->slice_lengths[s]; nnz_t base=S->slice_ptr[s];
+        for(idx_t k=0;k<slice_len;k++){
+            nnz_t offset=base+(nnz_t)k*C;
+            for(idx_t r=start;r<end;r++){
+                nnz_t idx=offset+(r-start);
+                y[S->perm[r]]+=S->values[idx]*x[S->col_idx[idx]];
+            }
+        }
+    }
+}
+
+// ------------------- Software prefetching (-pf) ------------
+// Prefetches the x element needed d entries ahead in the slice stream, and
+// the first values/col_idx lines of the next slice when a slice starts.
+// __builtin_prefetch is GCC/Clang only, other compilers run without it.
+#if defined(__GNUC__)
+#define PREFETCH_READ(p) __builtin_prefetch((p),0,0)
+#else
+#define PREFETCH_READ(p) ((void)(p))
+#endif
+#define PF_AUTO (-1)
+
+void sellcs_spmv_pf(const SELL_CS *S, const double *x, double *y, int d){
+    int C=S->C;
+    nnz_t last=S->slice_ptr[S->slices]-d;   // no prefetch past the end of col_idx
+#pragma omp parallel for schedule(runtime)
+    for(idx_t r=0;r<S->rows;r++) y[r]=0.0;
+
+#pragma omp parallel for schedule(runtime)
+    for(idx_t s=0;s<S->slices;s++){
+        idx_t start=s*C, end=(start+C<S->rows?start+C:S->rows);
+        idx_t slice_len=S->slice_lengths[s]; nnz_t base=S->slice_ptr[s];
+        if(s+1<S->slices){
+            PREFETCH_READ(&S->values[S->slice_ptr[s+1]]);
+            PREFETCH_READ(&S->col_idx[S->slice_ptr[s+1]]);
+        }
+        for(idx_t k=0;k<slice_len;k++){
+            nnz_t offset=base+(nnz_t)k*C;
+            for(idx_t r=start;r<end;r++){
+                nnz_t idx=offset+(r-start);
+                if(idx<last) PREFETCH_READ(&x[S->col_idx[idx+d]]);
+                y[S->perm[r]]+=S->values[idx]*x[S->col_idx[idx]];
+            }
+        }
+    }
+}
+
+// best of `runs` for d = 0 (plain kernel) and a range of distances
+int sellcs_pf_sweep(const SELL_CS *S, double *x, double *y, int runs){
+    static const int dists[]={0,4,8,16,32,64,128,256};
+    int nd=(int)(sizeof(dists)/sizeof(dists[0])), best_d=0;
+    double best_t=0.0, plain=0.0;
+    printf("Prefetch distance sweep (best of %d):\n",runs);
+    for(int k=0;k<nd;k++){
+        double best=0.0;
+        for(int r=0;r<runs;r++){
+            for(idx_t j=0;j<S->cols;j++) x[j]=(double)rand()/RAND_MAX;
+            double t0=get_ms();
+            if(dists[k]==0) sellcs_spmv(S,x,y);
+            else sellcs_spmv_pf(S,x,y,dists[k]);
+            double t=get_ms()-t0;
+            if(r==0 || t<best) best=t;
+        }
+        if(k==0) plain=best;
+        printf("  d = %-4d %.6f ms  (speedup %.2fx)\n",dists[k],best,plain/best);
+        if(k==0 || best<best_t){ best_t=best; best_d=dists[k]; }
+    }
+    printf("Chosen prefetch distance: %d\n",best_d);
+    return best_d;
+}
+
+// ------------------- Non-temporal y stores (-store nt) ----
+// Each slice is summed into a per-thread buffer of C rows and written once,
+// so y is neither zeroed nor read. A slice whose rows are consecutive in y
+// (always the case with -s 1) is written with streaming stores that bypass
+// the cache; σ-sorted slices scatter through perm with ordinary stores.
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HAVE_STREAM_STORES 1
+#else
+#define HAVE_STREAM_STORES 0
+#endif
+
+static inline void stream_store(double *dst, const double *src, idx_t n){
+#if HAVE_STREAM_STORES
+    idx_t i=0;
+    if(((uintptr_t)dst&15) && n>0){ dst[0]=src[0]; i=1; }   // _mm_stream_pd needs 16-byte alignment
+    for(;i+1<n;i+=2) _mm_stream_pd(dst+i,_mm_loadu_pd(src+i));
+    if(i<n) dst[i]=src[i];
+#else
+    memcpy(dst,src,(size_t)n*sizeof(double));
+#endif
+}
+
+void sellcs_spmv_nt(const SELL_CS *S, const double *x, double *y){
+    int C=S->C;
+#pragma omp parallel
+    {
+        double *buf=malloc((size_t)C*sizeof(double));
+#pragma omp for schedule(runtime) nowait
+        for(idx_t s=0;s<S->slices;s++){
+            idx_t start=s*C, end=(start+C<S->rows?start+C:S->rows), n=end-start;
+            idx_t slice_len=S->slice_lengths[s]; nnz_t base=S->slice_ptr[s];
+            for(idx_t r=0;r<n;r++) buf[r]=0.0;
+            for(idx_t k=0;k<slice_len;k++){
+                nnz_t offset=base+(nnz_t)k*C;
+                for(idx_t r=0;r<n;r++)
+                    buf[r]+=S->values[offset+r]*x[S->col_idx[offset+r]];
+            }
+            idx_t first=S->perm[start], r=1;
+            while(r<n && S->perm[start+r]==first+r) r++;
+            if(r==n) stream_store(&y[first],buf,n);
+            else for(r=0;r<n;r++) y[S->perm[start+r]]=buf[r];
+        }
+#if HAVE_STREAM_STORES
+        _mm_sfence();   // streamed lines are visible to the other threads after the barrier
+#endif
+        free(buf);
+    }
+}
+
+// ------------------- Reduced-precision values --------------
+// Only the stored values lose precision, y is accumulated in double.
+uint16_t float_to_bf16(float f){
+    uint32_t bits; memcpy(&bits,&f,sizeof(bits));
+    bits += 0x7FFF + ((bits>>16)&1);   // round to nearest even
+    return (uint16_t)(bits>>16);
+}
+
+static inline double bf16_to_double(uint16_t h){
+    uint32_t bits=(uint32_t)h<<16; float f;
+    memcpy(&f,&bits,sizeof(f));
+    return (double)f;
+}
+
+void sellcs_set_precision(SELL_CS *S, int prec){
+    nnz_t total=S->slice_ptr[S->slices];
+    if(prec==PREC_FLOAT){
+        S->values_f=arena_alloc((size_t)total*sizeof(float));
+        for(nnz_t i=0;i<total;i++) S->values_f[i]=(float)S->values[i];
+    } else if(prec==PREC_BF16){
+        S->values_h=arena_alloc((size_t)total*sizeof(uint16_t));
+        for(nnz_t i=0;i<total;i++) S->values_h[i]=float_to_bf16((float)S->values[i]);
+    }
+}
+
+void sellcs_spmv_float(const SELL_CS *S, const double *x, double *y){
+    int C=S->C;
+#pragma omp parallel for schedule(runtime)
+    for(idx_t r=0;r<S->rows;r++) y[r]=0.0;
+
+#pragma omp parallel for schedule(runtime)
+    for(idx_t s=0;s<S->slices;s++){
+        idx_t start=s*C, end=(start+C<S->rows?start+C:S->rows);
+        idx_t slice_len=S->slice_lengths[s]; nnz_t base=S->slice_ptr[s];
+        for(idx_t k=0;k<slice_len;k++){
+            nnz_t offset=base+(nnz_t)k*C;
+            for(idx_t r=start;r<end;r++){
+                nnz_t idx=offset+(r-start);
+                y[S->perm[r]]+=(double)S->values_f[idx]*x[S->col_idx[idx]];
+            }
+        }
+    }
+}
+
+void sellcs_spmv_bf16(const SELL_CS *S, const double *x, double *y){
+    int C=S->C;
+#pragma omp parallel for schedule(runtime)
+    for(idx_t r=0;r<S->rows;r++) y[r]=0.0;
+
+#pragma omp parallel for schedule(runtime)
+    for(idx_t s=0;s<S->slices;s++){
+        idx_t start=s*C, end=(start+C<S->rows?start+C:S->rows);
+        idx_t slice_len=S->slice_lengths[s]; nnz_t base=S->slice_ptr[s];
+        for(idx_t k=0;k<slice_len;k++){
+            nnz_t offset=base+(nnz_t)k*C;
+            for(idx_t r=start;r<end;r++){
+                nnz_t idx=offset+(r-start);
+                y[S->perm[r]]+=bf16_to_double(S->values_h[idx])*x[S->col_idx[idx]];
+            }
+        }
+    }
+}
+
+void sellcs_spmv_prec(const SELL_CS *S, int prec, const double *x, double *y){
+    if(prec==PREC_FLOAT) sellcs_spmv_float(S,x,y);
+    else if(prec==PREC_BF16) sellcs_spmv_bf16(S,x,y);
+    else sellcs_spmv(S,x,y);
+}
+
+// max |y_low - y_ref| / ||y_ref||_inf over a few random x
+double sellcs_precision_error(const SELL_CS *S, int prec, double *x, double *y,
+                              double *y_ref, int samples){
+    double max_err=0.0;
+    for(int s=0;s<samples;s++){
+        for(idx_t j=0;j<S->cols;j++) x[j]=(double)rand()/RAND_MAX;
+        sellcs_spmv(S,x,y_ref);
+        sellcs_spmv_prec(S,prec,x,y);
+        double diff=0.0, norm=0.0;
+        for(idx_t r=0;r<S->rows;r++){
+            if(fabs(y[r]-y_ref[r])>diff) diff=fabs(y[r]-y_ref[r]);
+            if(fabs(y_ref[r])>norm) norm=fabs(y_ref[r]);
+        }
+        double err = norm>0.0 ? diff/norm : diff;
+        if(err>max_err) max_err=err;
+    }
+    return max_err;
+}
+
+// ------------------- SELL-C SpMM --------------------------
+// Y = A X, X is cols x k and Y rows x k, both row-major. Each slice entry is
+// loaded once and applied to all k vectors; k = 2, 4, 8, 16 get a constant
+// inner trip count, anything else goes through the generic kernel.
+#define DEFINE_SELL_SPMM(K)                                                    \
+void sellcs_spmm##K(const SELL_CS *S, const double *X, double *Y){             \
+    int C=S->C;                                                                \
+    _Pragma("omp parallel for schedule(runtime)")                              \
+    for(idx_t s=0;s<S->slices;s++){                                            \
+        idx_t start=s*C, end=(start+C<S->rows?start+C:S->rows);                \
+        idx_t slice_len=S->slice_lengths[s]; nnz_t base=S->slice_ptr[s];       \
+        for(idx_t r=start;r<end;r++){                                          \
+            double *yr=Y+(size_t)S->perm[r]*K;                                 \
+            for(int t=0;t<K;t++) yr[t]=0.0;                                    \
+        }                                                                      \
+        for(idx_t k=0;k<slice_len;k++){                                        \
+            nnz_t offset=base+(nnz_t)k*C;                                      \
+            for(idx_t r=start;r<end;r++){                                      \
+                nnz_t idx=offset+(r-start);                                    \
+                double v=S->values[idx];                                       \
+                const double *xr=X+(size_t)S->col_idx[idx]*K;                  \
+                double *yr=Y+(size_t)S->perm[r]*K;                             \
+                _Pragma("omp simd")                                            \
+                for(int t=0;t<K;t++) yr[t]+=v*xr[t];                           \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+}
+
+DEFINE_SELL_SPMM(2)
+DEFINE_SELL_SPMM(4)
+DEFINE_SELL_SPMM(8)
+DEFINE_SELL_SPMM(16)
 
+void sellcs_spmm_generic(const SELL_CS *S, int nv, const double *X, double *Y){
+    int C=S->C;
 #pragma omp parallel for schedule(runtime)
-    for(int s=0;s<S->slices;s++){
-        int start=s*C, end=(start+C<S->rows?start+C:S->rows);
-        int slice_len=S->slice_lengths[s], base=S->slice_ptr[s];
-        for(int k=0;k<slice_len;k++){
-            int offset=base+k*C;
-            for(int r=start;r<end;r++){
-                int idx=offset+(r-start);
-                y[r]+=S->values[idx]*x[S->col_idx[idx]];
+    for(idx_t s=0;s<S->slices;s++){
+        idx_t start=s*C, end=(start+C<S->rows?start+C:S->rows);
+        idx_t slice_len=S->slice_lengths[s]; nnz_t base=S->slice_ptr[s];
+        for(idx_t r=start;r<end;r++){
+            double *yr=Y+(size_t)S->perm[r]*nv;
+            for(int t=0;t<nv;t++) yr[t]=0.0;
+        }
+        for(idx_t k=0;k<slice_len;k++){
+            nnz_t offset=base+(nnz_t)k*C;
+            for(idx_t r=start;r<end;r++){
+                nnz_t idx=offset+(r-start);
+                double v=S->values[idx];
+                const double *xr=X+(size_t)S->col_idx[idx]*nv;
+                double *yr=Y+(size_t)S->perm[r]*nv;
+#pragma omp simd
+                for(int t=0;t<nv;t++) yr[t]+=v*xr[t];
             }
         }
     }
 }
 
+void sellcs_spmm(const SELL_CS *S, int nv, const double *X, double *Y){
+    switch(nv){
+        case 2:  sellcs_spmm2(S,X,Y); break;
+        case 4:  sellcs_spmm4(S,X,Y); break;
+        case 8:  sellcs_spmm8(S,X,Y); break;
+        case 16: sellcs_spmm16(S,X,Y); break;
+        default: sellcs_spmm_generic(S,nv,X,Y); break;
+    }
+}
+
+// ------------------- Fused SpMV + dot (+ axpy) ------------
+// One partial sum per thread, padded to a cache line.
+typedef struct { double v; char pad[64-sizeof(double)]; } padded_sum;
+
+// y = A x, returns <x,y>; if r != NULL also r -= alpha*y. Each slice's rows
+// are finished in registers/L1 before moving on, so y is never re-read.
+double sellcs_spmv_dot(const SELL_CS *S, const double *x, double *y,
+                       double alpha, double *r, padded_sum *slots){
+    int C=S->C, nthreads=1;
+#pragma omp parallel
+    {
+        int t=omp_get_thread_num();
+        if(t==0) nthreads=omp_get_num_threads();
+        double dot=0.0;
+#pragma omp for schedule(runtime) nowait
+        for(idx_t s=0;s<S->slices;s++){
+            idx_t start=s*C, end=(start+C<S->rows?start+C:S->rows);
+            idx_t slice_len=S->slice_lengths[s]; nnz_t base=S->slice_ptr[s];
+            for(idx_t i=start;i<end;i++) y[S->perm[i]]=0.0;
+            for(idx_t k=0;k<slice_len;k++){
+                nnz_t offset=base+(nnz_t)k*C;
+                for(idx_t i=start;i<end;i++){
+                    nnz_t idx=offset+(i-start);
+                    y[S->perm[i]]+=S->values[idx]*x[S->col_idx[idx]];
+                }
+            }
+            for(idx_t i=start;i<end;i++){
+                idx_t row=S->perm[i];
+                dot+=x[row]*y[row];
+                if(r) r[row]-=alpha*y[row];
+            }
+        }
+        slots[t].v=dot;
+    }
+    double dot=0.0;
+    for(int t=0;t<nthreads;t++) dot+=slots[t].v;
+    return dot;
+}
+
+// ------------------- Fused residual r = b - A x -----------
+// Writes r and returns ||r||^2; the slice's rows are accumulated in r itself
+// and turned into b - A x before the next slice.
+double sellcs_residual(const SELL_CS *S, const double *x, const double *b,
+                       double *r, padded_sum *slots){
+    int C=S->C, nthreads=1;
+#pragma omp parallel
+    {
+        int t=omp_get_thread_num();
+        if(t==0) nthreads=omp_get_num_threads();
+        double nrm=0.0;
+#pragma omp for schedule(runtime) nowait
+        for(idx_t s=0;s<S->slices;s++){
+            idx_t start=s*C, end=(start+C<S->rows?start+C:S->rows);
+            idx_t slice_len=S->slice_lengths[s]; nnz_t base=S->slice_ptr[s];
+            for(idx_t i=start;i<end;i++) r[S->perm[i]]=0.0;
+            for(idx_t k=0;k<slice_len;k++){
+                nnz_t offset=base+(nnz_t)k*C;
+                for(idx_t i=start;i<end;i++){
+                    nnz_t idx=offset+(i-start);
+                    r[S->perm[i]]+=S->values[idx]*x[S->col_idx[idx]];
+                }
+            }
+            for(idx_t i=start;i<end;i++){
+                idx_t row=S->perm[i];
+                double ri=b[row]-r[row];
+                r[row]=ri;
+                nrm+=ri*ri;
+            }
+        }
+        slots[t].v=nrm;
+    }
+    double nrm=0.0;
+    for(int t=0;t<nthreads;t++) nrm+=slots[t].v;
+    return nrm;
+}
+
+// ------------------- Conjugate Gradient -------------------
+// q = A p for one slice, returns this slice's part of p.q. Used inside the
+// CG parallel region so the dot product is taken while q is still in cache.
+static inline double sellcs_slice_dot(const SELL_CS *S, int prec, idx_t s,
+                                      const double *p, double *q){
+    int C=S->C;
+    idx_t start=s*C, end=(start+C<S->rows?start+C:S->rows);
+    idx_t slice_len=S->slice_lengths[s]; nnz_t base=S->slice_ptr[s];
+    for(idx_t r=start;r<end;r++) q[S->perm[r]]=0.0;
+    for(idx_t k=0;k<slice_len;k++){
+        nnz_t offset=base+(nnz_t)k*C;
+        for(idx_t r=start;r<end;r++){
+            nnz_t idx=offset+(r-start);
+            double v = prec==PREC_FLOAT ? (double)S->values_f[idx]
+                     : prec==PREC_BF16 ? bf16_to_double(S->values_h[idx]) : S->values[idx];
+            q[S->perm[r]]+=v*p[S->col_idx[idx]];
+        }
+    }
+    double pq=0.0;
+    for(idx_t r=start;r<end;r++) pq+=p[S->perm[r]]*q[S->perm[r]];
+    return pq;
+}
+
+// CG from x = 0, one parallel region per iteration (SpMV + p.q, x/r update
+// + r.r, p update). Returns iterations, or -iterations if p.Ap <= 0.
+int sellcs_cg(const SELL_CS *S, int prec, const double *b, double *x, double *r,
+              double *p, double *q, int maxit, double tol,
+              double *rel_res, double *spmv_ms, double *vec_ms){
+    idx_t n=S->rows;
+    double bb=0.0;
+#pragma omp parallel for schedule(static) reduction(+:bb)
+    for(idx_t i=0;i<n;i++){ x[i]=0.0; r[i]=b[i]; p[i]=b[i]; bb+=b[i]*b[i]; }
+
+    double rr=bb;
+    int it=0;
+    *spmv_ms=*vec_ms=0.0;
+    while(it<maxit && rr>tol*tol*bb){
+        double pq=0.0, rr_new=0.0, t_mid=0.0;
+        double t0=get_ms();
+#pragma omp parallel
+        {
+#pragma omp for schedule(runtime) reduction(+:pq)
+            for(idx_t s=0;s<S->slices;s++) pq+=sellcs_slice_dot(S,prec,s,p,q);
+#pragma omp master
+            t_mid=get_ms();
+
+            double alpha=rr/pq;
+#pragma omp for schedule(static) reduction(+:rr_new)
+            for(idx_t i=0;i<n;i++){
+                x[i]+=alpha*p[i]; r[i]-=alpha*q[i]; rr_new+=r[i]*r[i];
+            }
+            double beta=rr_new/rr;
+#pragma omp for schedule(static)
+            for(idx_t i=0;i<n;i++) p[i]=r[i]+beta*p[i];
+        }
+        *spmv_ms+=t_mid-t0;
+        *vec_ms+=get_ms()-t_mid;
+        it++;
+        if(pq<=0.0){ *rel_res=sqrt(rr_new/bb); return -it; }
+        rr=rr_new;
+    }
+    *rel_res = bb>0.0 ? sqrt(rr/bb) : 0.0;
+    return it;
+}
+
+// ------------------- Eigenvalue modes (-eig) ---------------
+#define ORTH_BLOCK 512   // rows per block in the reorthogonalization sweeps
+
+int cmp_double(const void *a, const void *b){
+    double da=*(const double*)a, db=*(const double*)b;
+    return (da>db)-(da<db);
+}
+
+// Symmetric tridiagonal eigenvalues (diagonal d, off-diagonal e[0..n-2]) by
+// implicit QL; d ends up sorted ascending, e is destroyed. 0 = no convergence.
+int tridiag_eigenvalues(double *d, double *e, int n){
+    if(n>0) e[n-1]=0.0;
+    for(int l=0;l<n;l++){
+        int iter=0, m;
+        do{
+            for(m=l;m<n-1;m++) if(fabs(e[m])<=1e-15*(fabs(d[m])+fabs(d[m+1]))) break;
+            if(m!=l){
+                if(iter++==60) return 0;
+                double g=(d[l+1]-d[l])/(2.0*e[l]), r=hypot(g,1.0);
+                g=d[m]-d[l]+e[l]/(g+copysign(r,g));
+                double s=1.0, c=1.0, p=0.0;
+                int i;
+                for(i=m-1;i>=l;i--){
+                    double f=s*e[i], b=c*e[i];
+                    e[i+1]=r=hypot(f,g);
+                    if(r==0.0){ d[i+1]-=p; e[m]=0.0; break; }
+                    s=f/r; c=g/r; g=d[i+1]-p;
+                    r=(d[i]-g)*s+2.0*c*b;
+                    p=s*r; d[i+1]=g+p; g=c*r-b;
+                }
+                if(r==0.0 && i>=l) continue;
+                d[l]-=p; e[l]=g; e[m]=0.0;
+            }
+        } while(m!=l);
+    }
+    qsort(d,(size_t)n,sizeof(double),cmp_double);
+    return 1;
+}
+
+// One blocked classical Gram-Schmidt pass of w against V[:,0..k-1] (column-major):
+// h = V^T w, w -= V h. h_part has h_stride partial sums per thread.
+void cgs_pass(idx_t n, const double *V, int k, double *w, double *h, double *h_part, int h_stride){
+#pragma omp parallel
+    {
+        int t=omp_get_thread_num(), nt=omp_get_num_threads();
+        double *ht=h_part+(size_t)t*h_stride;
+        for(int q=0;q<k;q++) ht[q]=0.0;
+#pragma omp for schedule(static)
+        for(idx_t ib=0;ib<n;ib+=ORTH_BLOCK){
+            idx_t ie=ib+ORTH_BLOCK<n?ib+ORTH_BLOCK:n;
+            for(int q=0;q<k;q++){
+                const double *vq=V+(size_t)q*n; double s=0.0;
+                for(idx_t i=ib;i<ie;i++) s+=vq[i]*w[i];
+                ht[q]+=s;
+            }
+        }
+#pragma omp for schedule(static)
+        for(int q=0;q<k;q++){
+            double s=0.0;
+            for(int u=0;u<nt;u++) s+=h_part[(size_t)u*h_stride+q];
+            h[q]=s;
+        }
+#pragma omp for schedule(static)
+        for(idx_t ib=0;ib<n;ib+=ORTH_BLOCK){
+            idx_t ie=ib+ORTH_BLOCK<n?ib+ORTH_BLOCK:n;
+            for(int q=0;q<k;q++){
+                const double *vq=V+(size_t)q*n; double hq=h[q];
+                for(idx_t i=ib;i<ie;i++) w[i]-=hq*vq[i];
+            }
+        }
+    }
+}
+
+double par_norm(idx_t n, const double *v){
+    double s=0.0;
+#pragma omp parallel for schedule(static) reduction(+:s)
+    for(idx_t i=0;i<n;i++) s+=v[i]*v[i];
+    return sqrt(s);
+}
+
+void par_scale(idx_t n, const double *v, double a, double *out){
+#pragma omp parallel for schedule(static)
+    for(idx_t i=0;i<n;i++) out[i]=a*v[i];
+}
+
+// Lanczos with full CGS2 reorthogonalization, up to m steps. Returns steps taken.
+int sellcs_lanczos(const SELL_CS *S, int prec, int m, double *alpha, double *beta,
+                   double *V, double *w, double *h, double *h_part, int h_stride,
+                   double *spmv_ms, double *orth_ms){
+    idx_t n=S->rows;
+    for(idx_t i=0;i<n;i++) w[i]=(double)rand()/RAND_MAX-0.5;
+    par_scale(n,w,1.0/par_norm(n,w),V);
+    *spmv_ms=*orth_ms=0.0;
+    int steps=0;
+    for(int j=0;j<m;j++){
+        double t0=get_ms();
+        sellcs_spmv_prec(S,prec,V+(size_t)j*n,w);
+        double t1=get_ms();
+        cgs_pass(n,V,j+1,w,h,h_part,h_stride); alpha[j]=h[j];
+        cgs_pass(n,V,j+1,w,h,h_part,h_stride); alpha[j]+=h[j];
+        beta[j]=par_norm(n,w);
+        double t2=get_ms();
+        *spmv_ms+=t1-t0; *orth_ms+=t2-t1;
+        steps=j+1;
+        if(beta[j]<=1e-12*fabs(alpha[j]) || j+1==m) break;
+        par_scale(n,w,1.0/beta[j],V+(size_t)(j+1)*n);
+    }
+    return steps;
+}
+
+// Power iteration (Rayleigh quotient of the largest-magnitude eigenvalue)
+int sellcs_power(const SELL_CS *S, int prec, int maxit, double tol, double *v, double *w, double *lambda){
+    idx_t n=S->rows;
+    for(idx_t i=0;i<n;i++) w[i]=(double)rand()/RAND_MAX;
+    par_scale(n,w,1.0/par_norm(n,w),v);
+    double prev=0.0; *lambda=0.0;
+    int it=0;
+    while(it<maxit){
+        sellcs_spmv_prec(S,prec,v,w);
+        double vw=0.0, ww=0.0;
+#pragma omp parallel for schedule(static) reduction(+:vw,ww)
+        for(idx_t i=0;i<n;i++){ vw+=v[i]*w[i]; ww+=w[i]*w[i]; }
+        it++; *lambda=vw;
+        if(ww==0.0) break;
+        par_scale(n,w,1.0/sqrt(ww),v);
+        if(it>1 && fabs(*lambda-prev)<=tol*fabs(*lambda)) break;
+        prev=*lambda;
+    }
+    return it;
+}
+
 // ------------------- Main -------------------------------
 int main(int argc, char **argv){
     if(argc<10){
-        printf("Usage: %s <matrix_file> -r <runs> -c <chunk> -s <sigma> -t <threads>\n",argv[0]);
+        printf("Usage: %s <matrix_file> -r <runs> -c <chunk> -s <sigma> -t <threads> [-p double|float|bf16] [-k vectors]\n"
+               "       [-op ax|dot|res] [-solve cg | -eig power|lanczos]\n"
+               "       [-maxit n] [-tol t] [-nev n] [-pf d|auto] [-store normal|nt]\n",argv[0]);
         return 1;
     }
 
@@ -126,59 +835,369 @@ int main(int argc, char **argv){
     int threads = atoi(argv[9]);
     omp_set_num_threads(threads);
 
+    // optional flags after the fixed ones
+    int prec = PREC_DOUBLE;
+    const char *prec_str = "double";
+    int nv = 1;   // vectors per multiply (-k)
+    const char *solve = NULL;
+    int op_dot = 0;   // -op dot: fused y = A x, <x,y>, r -= alpha y
+    int op_res = 0;   // -op res: fused r = b - A x, ||r||^2
+    const char *eig = NULL;
+    int nev = 5;
+    int maxit = 0;    // 0 = default of the mode: 1000 (CG, power), 100 (Lanczos)
+    double tol = 1e-8;
+    int pf = 0;       // -pf: prefetch distance, 0 = off, PF_AUTO = sweep
+    int nt_store = 0; // -store nt: non-temporal y stores
+    for(int i=10;i<argc;i++){
+        if(strcmp(argv[i],"-p")==0 && i+1<argc){
+            prec_str=argv[++i];
+            if(strcmp(prec_str,"double")==0) prec=PREC_DOUBLE;
+            else if(strcmp(prec_str,"float")==0) prec=PREC_FLOAT;
+            else if(strcmp(prec_str,"bf16")==0) prec=PREC_BF16;
+            else { printf("Unknown precision '%s'. Valid: double, float, bf16\n",prec_str); return 1; }
+        } else if(strcmp(argv[i],"-k")==0 && i+1<argc){
+            nv=atoi(argv[++i]);
+            if(nv<1) nv=1;
+        } else if(strcmp(argv[i],"-op")==0 && i+1<argc){
+            const char *op=argv[++i];
+            if(strcmp(op,"dot")==0) op_dot=1;
+            else if(strcmp(op,"res")==0) op_res=1;
+            else if(strcmp(op,"ax")!=0){ printf("Unknown operation '%s'. Valid: ax, dot, res\n",op); return 1; }
+        } else if(strcmp(argv[i],"-solve")==0 && i+1<argc){
+            solve=argv[++i];
+            if(strcmp(solve,"cg")!=0){ printf("Unknown solver '%s'. Valid: cg\n",solve); return 1; }
+        } else if(strcmp(argv[i],"-maxit")==0 && i+1<argc){
+            maxit=atoi(argv[++i]);
+            if(maxit<0) maxit=0;
+        } else if(strcmp(argv[i],"-eig")==0 && i+1<argc){
+            eig=argv[++i];
+            if(strcmp(eig,"power")!=0 && strcmp(eig,"lanczos")!=0){
+                printf("Unknown eigen method '%s'. Valid: power, lanczos\n",eig); return 1;
+            }
+        } else if(strcmp(argv[i],"-nev")==0 && i+1<argc){
+            nev=atoi(argv[++i]);
+            if(nev<1) nev=5;
+        } else if(strcmp(argv[i],"-pf")==0 && i+1<argc){
+            i++;
+            pf = strcmp(argv[i],"auto")==0 ? PF_AUTO : atoi(argv[i]);
+            if(pf<PF_AUTO) pf=0;
+        } else if(strcmp(argv[i],"-store")==0 && i+1<argc){
+            const char *st=argv[++i];
+            if(strcmp(st,"nt")==0) nt_store=1;
+            else if(strcmp(st,"normal")!=0){ printf("Unknown store mode '%s'. Valid: normal, nt\n",st); return 1; }
+        } else if(strcmp(argv[i],"-tol")==0 && i+1<argc){
+            tol=atof(argv[++i]);
+            if(tol<=0.0) tol=1e-8;
+        } else {
+            printf("Unknown option: %s\n",argv[i]); return 1;
+        }
+    }
+    if(nv>1 && prec!=PREC_DOUBLE){ printf("Error: -k is only implemented for -p double.\n"); return 1; }
+    if(solve && nv>1){ printf("Error: -solve is only implemented for -k 1.\n"); return 1; }
+    if(eig && (nv>1 || solve)){ printf("Error: -eig is only implemented for -k 1 and without -solve.\n"); return 1; }
+    int lanczos = eig && strcmp(eig,"lanczos")==0;
+    if(maxit==0) maxit = lanczos ? 100 : 1000;
+    if((op_dot || op_res) && (nv>1 || solve || eig || prec!=PREC_DOUBLE)){
+        printf("Error: -op dot/res are only implemented for -k 1, -p double and without -solve/-eig.\n"); return 1;
+    }
+
+    if(pf!=0 && (nv>1 || solve || eig || op_dot || op_res || prec!=PREC_DOUBLE)){
+        printf("Error: -pf is only implemented for the plain SpMV runs with -k 1 and -p double.\n"); return 1;
+    }
+
+    if(nt_store && (pf!=0 || nv>1 || solve || eig || op_dot || op_res || prec!=PREC_DOUBLE)){
+        printf("Error: -store nt is only implemented for the plain SpMV runs with -k 1, -p double and without -pf.\n"); return 1;
+    }
+    if(nt_store && !HAVE_STREAM_STORES) printf("Warning: no streaming stores in this build, -store nt uses ordinary stores.\n");
+
     // ------------------ Load Matrix Market ----------------
     FILE *f = fopen(matrix_file,"r");
     if(!f){printf("Error opening matrix.\n"); return 1;}
 
-    // skip comments
+    // skip comments; the banner on the first line tells whether one triangle is stored
     char line[512];
-    while(fgets(line,sizeof(line),f))
+    int symmetric=0, first=1;
+    while(fgets(line,sizeof(line),f)){
         if(line[0]!='%') break;
-    int rows,cols,nnz;
-    if(sscanf(line,"%d %d %d",&rows,&cols,&nnz)!=3){
+        if(first && strstr(line,"MatrixMarket") && strstr(line,"symmetric") && !strstr(line,"skew"))
+            symmetric=1;
+        first=0;
+    }
+    long long hdr_rows,hdr_cols,hdr_nnz;
+    if(sscanf(line,"%lld %lld %lld",&hdr_rows,&hdr_cols,&hdr_nnz)!=3){
         printf("Error: invalid matrix header.\n"); fclose(f); return 1;
     }
+    if(hdr_nnz>NNZ_MAX){
+        printf("Error: %lld nonzeros do not fit in %d-bit offsets, rebuild with -DMVM_INDEX64.\n",
+               hdr_nnz,(int)(8*sizeof(nnz_t)));
+        fclose(f); return 1;
+    }
+    if(hdr_rows>IDX_MAX || hdr_cols>IDX_MAX){
+        printf("Error: matrix dimensions do not fit in %d-bit indices, rebuild with -DMVM_COL64.\n",
+               (int)(8*sizeof(idx_t)));
+        fclose(f); return 1;
+    }
+    idx_t rows=(idx_t)hdr_rows, cols=(idx_t)hdr_cols;
+    nnz_t nnz=(nnz_t)hdr_nnz;
 
-    int *row = malloc(nnz*sizeof(int));
-    int *col = malloc(nnz*sizeof(int));
-    double *val = malloc(nnz*sizeof(double));
-    for(int i=0;i<nnz;i++){
-        if(fscanf(f,"%d %d %lf",&row[i],&col[i],&val[i])!=3){
-            printf("Error reading matrix entry %d\n",i); fclose(f); return 1;
+    // room for the mirrored entries when a symmetric file is expanded (arena slices cannot grow)
+    size_t cap = (size_t)nnz*(((solve || eig) && symmetric) ? 2 : 1);
+    idx_t *row = arena_alloc(cap*sizeof(idx_t));
+    idx_t *col = arena_alloc(cap*sizeof(idx_t));
+    double *val = arena_alloc(cap*sizeof(double));
+    for(nnz_t i=0;i<nnz;i++){
+        if(fscanf(f,IDX_SCN " " IDX_SCN " %lf",&row[i],&col[i],&val[i])!=3){
+            printf("Error reading matrix entry " NNZ_FMT "\n",i); fclose(f); return 1;
         }
         row[i]--; col[i]--; // convert to 0-based
     }
     fclose(f);
 
+    // ------------------ Symmetric expansion (CG) ----------
+    if(solve){
+        if(rows!=cols){ printf("Error: -solve cg needs a square matrix.\n"); return 1; }
+        if(!symmetric) printf("Warning: file is not marked symmetric, CG assumes it is SPD as stored.\n");
+    }
+    if(eig){
+        if(rows!=cols){ printf("Error: -eig needs a square matrix.\n"); return 1; }
+        if(lanczos && !symmetric) printf("Warning: file is not marked symmetric, Lanczos assumes it is symmetric as stored.\n");
+    }
+    if((solve || eig) && symmetric){
+        nnz_t off=0;
+        for(nnz_t i=0;i<nnz;i++) if(row[i]!=col[i]) off++;
+        if((long long)nnz+off>NNZ_MAX){
+            printf("Error: expanded symmetric matrix does not fit in %d-bit offsets, rebuild with -DMVM_INDEX64.\n",
+                   (int)(8*sizeof(nnz_t)));
+            return 1;
+        }
+        nnz_t next=nnz;
+        for(nnz_t i=0;i<nnz;i++)
+            if(row[i]!=col[i]){ row[next]=col[i]; col[next]=row[i]; val[next]=val[i]; next++; }
+        printf("Expanded symmetric storage: " NNZ_FMT " -> " NNZ_FMT " non-zero elements\n",nnz,next);
+        nnz=next;
+    }
+
     // ------------------ Convert to CSR -------------------
-    int *rowptr = calloc(rows+1,sizeof(int));
-    for(int i=0;i<nnz;i++) rowptr[row[i]+1]++;
-    for(int i=0;i<rows;i++) rowptr[i+1]+=rowptr[i];
-
-    int *csr_col = malloc(nnz*sizeof(int));
-    double *csr_val = malloc(nnz*sizeof(double));
-    int *tmp = malloc((rows+1)*sizeof(int));
-    memcpy(tmp,rowptr,(rows+1)*sizeof(int));
-    for(int i=0;i<nnz;i++){
-        int r=row[i]; int pos=tmp[r]++;
+    nnz_t *rowptr = arena_alloc(((size_t)rows+1)*sizeof(nnz_t));
+    memset(rowptr,0,((size_t)rows+1)*sizeof(nnz_t));
+    for(nnz_t i=0;i<nnz;i++) rowptr[row[i]+1]++;
+    for(idx_t i=0;i<rows;i++) rowptr[i+1]+=rowptr[i];
+
+    idx_t *csr_col = arena_alloc((size_t)nnz*sizeof(idx_t));
+    double *csr_val = arena_alloc((size_t)nnz*sizeof(double));
+    nnz_t *tmp = malloc(((size_t)rows+1)*sizeof(nnz_t));
+    memcpy(tmp,rowptr,((size_t)rows+1)*sizeof(nnz_t));
+    for(nnz_t i=0;i<nnz;i++){
+        idx_t r=row[i]; nnz_t pos=tmp[r]++;
         csr_col[pos]=col[i];
         csr_val[pos]=val[i];
     }
 
-    free(row); free(col); free(val); free(tmp);
+    arena_free(row); arena_free(col); arena_free(val); free(tmp);
 
     // ------------------ Convert CSR → SELL-C ----------------
     SELL_CS *S = csr_to_sellcs(rows,cols,nnz,csr_val,csr_col,rowptr,chunk,sigma);
+    if(!S) return 1;
 
-    double *x = malloc(cols*sizeof(double));
-    double *y = malloc(rows*sizeof(double));
+    double *x = arena_alloc((size_t)cols*sizeof(double));
+    double *y = arena_alloc((size_t)rows*sizeof(double));
     double *times = malloc(runs*sizeof(double));
+    memset(x,0,(size_t)cols*sizeof(double));   // touched now so the report covers them
+    memset(y,0,(size_t)rows*sizeof(double));
+
+    // ------------------ Precision check -------------------
+    if(prec!=PREC_DOUBLE){
+        sellcs_set_precision(S,prec);
+        double *y_ref = malloc((size_t)rows*sizeof(double));
+        double err = sellcs_precision_error(S,prec,x,y,y_ref,3);
+        printf("Value precision: %s | max relative error vs double (3 random x, ||.||_inf): %.3e\n",
+               prec_str,err);
+        free(y_ref);
+    }
+    arena_report();
+
+    // ------------------ Run SpMM (-k) ---------------------
+    if(nv>1){
+        nnz_t nnz_total=rowptr[rows];
+        double *X=malloc((size_t)cols*nv*sizeof(double));
+        double *Y=malloc((size_t)rows*nv*sizeof(double));
+        double best=0.0, best_spmv=0.0;
+        for(int r=0;r<runs;r++){
+            for(size_t j=0;j<(size_t)cols*nv;j++) X[j]=(double)rand()/RAND_MAX;
+            double t0=get_ms();
+            sellcs_spmm(S,nv,X,Y);
+            double t1=get_ms();
+            times[r]=t1-t0;
+
+            // reference: nv independent SpMVs, also checks the result
+            double spmv=0.0, max_diff=0.0;
+            for(int t=0;t<nv;t++){
+                for(idx_t j=0;j<cols;j++) x[j]=X[(size_t)j*nv+t];
+                double s0=get_ms();
+                sellcs_spmv(S,x,y);
+                spmv+=get_ms()-s0;
+                for(idx_t i=0;i<rows;i++)
+                    if(fabs(Y[(size_t)i*nv+t]-y[i])>max_diff) max_diff=fabs(Y[(size_t)i*nv+t]-y[i]);
+            }
+            printf("Run %d: %.6f ms   (%d x SpMV: %.6f ms, max diff %.1e)\n",r+1,times[r],nv,spmv,max_diff);
+            if(r==0 || times[r]<best) best=times[r];
+            if(r==0 || spmv<best_spmv) best_spmv=spmv;
+        }
+        double flops=2.0*(double)nnz_total*nv;   // 2*nnz per vector
+        printf("SpMM k=%d best: %.6f ms (%.6f ms per vector), %.3f GFLOP/s\n",
+               nv,best,best/nv,flops/(best*1e6));
+        printf("%d x SpMV best: %.6f ms (%.6f ms per vector), %.3f GFLOP/s (SpMM speedup %.3f)\n",
+               nv,best_spmv,best_spmv/nv,flops/(best_spmv*1e6),best_spmv/best);
+        free(X); free(Y);
+    }
+
+    // ------------------ Run CG (-solve) -------------------
+    if(solve){
+        double *b=malloc((size_t)rows*sizeof(double));
+        double *cr=malloc((size_t)rows*sizeof(double));
+        double *cp=malloc((size_t)rows*sizeof(double));
+        double *cq=malloc((size_t)rows*sizeof(double));
+        for(idx_t i=0;i<rows;i++) x[i]=1.0;
+        sellcs_spmv_prec(S,prec,x,b);      // b = A*1, exact solution is all ones
+        int it=0; double rel=0.0, spmv_ms=0.0, vec_ms=0.0;
+        for(int r=0;r<runs;r++){
+            double t0=get_ms();
+            it=sellcs_cg(S,prec,b,x,cr,cp,cq,maxit,tol,&rel,&spmv_ms,&vec_ms);
+            times[r]=get_ms()-t0;
+            int n_it = it<0 ? -it : it;
+            printf("Run %d: %.6f ms   (%d iterations, %.6f ms/iter)\n",r+1,times[r],n_it,times[r]/(n_it>0?n_it:1));
+        }
+        if(it<0){ printf("CG breakdown: p.Ap <= 0 at iteration %d, the matrix is not SPD.\n",-it); it=-it; }
+        // True residual and error of the last solve, outside the timed loop
+        sellcs_spmv_prec(S,prec,x,cq);
+        double res=0.0, bnorm=0.0, err=0.0;
+        for(idx_t i=0;i<rows;i++){
+            res+=(b[i]-cq[i])*(b[i]-cq[i]);
+            bnorm+=b[i]*b[i];
+            if(fabs(x[i]-1.0)>err) err=fabs(x[i]-1.0);
+        }
+        int d = it>0 ? it : 1;
+        printf("CG: %d iterations, recursive residual %.3e, true residual %.3e, max |x - 1| %.3e\n",
+               it,rel,bnorm>0.0?sqrt(res/bnorm):0.0,err);
+        printf("Per iteration (last run): SpMV + p.Ap %.6f ms, vector ops %.6f ms (%.1f%% of iteration)\n",
+               spmv_ms/d,vec_ms/d,100.0*vec_ms/(spmv_ms+vec_ms));
+        free(b); free(cr); free(cp); free(cq);
+    }
+
+    // ------------------ Run fused SpMV + dot (-op dot) ----
+    if(op_dot){
+        if(rows!=cols){ printf("Error: -op dot needs a square matrix.\n"); return 1; }
+        double *res=malloc((size_t)rows*sizeof(double));
+        double *res_ref=malloc((size_t)rows*sizeof(double));
+        padded_sum *slots=malloc((size_t)omp_get_max_threads()*sizeof(padded_sum));
+        const double alpha=0.5;
+        double best=0.0, best_ref=0.0, max_diff=0.0;
+        for(int r=0;r<runs;r++){
+            for(idx_t i=0;i<rows;i++){ x[i]=(double)rand()/RAND_MAX; res[i]=res_ref[i]=(double)rand()/RAND_MAX; }
+            double t0=get_ms();
+            double dot=sellcs_spmv_dot(S,x,y,alpha,res,slots);
+            double t1=get_ms();
+            sellcs_spmv(S,x,y);
+            double dot_ref=0.0;
+#pragma omp parallel for schedule(static) reduction(+:dot_ref)
+            for(idx_t i=0;i<rows;i++) dot_ref+=x[i]*y[i];
+#pragma omp parallel for schedule(static)
+            for(idx_t i=0;i<rows;i++) res_ref[i]-=alpha*y[i];
+            double t2=get_ms();
+            times[r]=t1-t0;
+            double diff=fabs(dot-dot_ref)/(fabs(dot_ref)>0.0?fabs(dot_ref):1.0);
+            for(idx_t i=0;i<rows;i++) if(fabs(res[i]-res_ref[i])>diff) diff=fabs(res[i]-res_ref[i]);
+            if(diff>max_diff) max_diff=diff;
+            printf("Run %d: %.6f ms   (unfused: %.6f ms)\n",r+1,times[r],t2-t1);
+            if(r==0 || times[r]<best) best=times[r];
+            if(r==0 || t2-t1<best_ref) best_ref=t2-t1;
+        }
+        printf("Fused best: %.6f ms, unfused best: %.6f ms (speedup %.3f), max difference %.3e\n",
+               best,best_ref,best_ref/best,max_diff);
+        free(res); free(res_ref); free(slots);
+    }
+
+    // ------------------ Run fused residual (-op res) -----
+    if(op_res){
+        double *b=malloc((size_t)rows*sizeof(double));
+        double *res=malloc((size_t)rows*sizeof(double));
+        padded_sum *slots=malloc((size_t)omp_get_max_threads()*sizeof(padded_sum));
+        double best=0.0, best_ref=0.0, max_diff=0.0;
+        for(int r=0;r<runs;r++){
+            for(idx_t j=0;j<cols;j++) x[j]=(double)rand()/RAND_MAX;
+            for(idx_t i=0;i<rows;i++) b[i]=(double)rand()/RAND_MAX;
+            double t0=get_ms();
+            double nrm=sellcs_residual(S,x,b,res,slots);
+            double t1=get_ms();
+            sellcs_spmv(S,x,y);
+#pragma omp parallel for schedule(static)
+            for(idx_t i=0;i<rows;i++) y[i]=b[i]-y[i];
+            double nrm_ref=0.0;
+#pragma omp parallel for schedule(static) reduction(+:nrm_ref)
+            for(idx_t i=0;i<rows;i++) nrm_ref+=y[i]*y[i];
+            double t2=get_ms();
+            times[r]=t1-t0;
+            double diff=fabs(nrm-nrm_ref)/(nrm_ref>0.0?nrm_ref:1.0);
+            for(idx_t i=0;i<rows;i++) if(fabs(res[i]-y[i])>diff) diff=fabs(res[i]-y[i]);
+            if(diff>max_diff) max_diff=diff;
+            printf("Run %d: %.6f ms   (unfused: %.6f ms)\n",r+1,times[r],t2-t1);
+            if(r==0 || times[r]<best) best=times[r];
+            if(r==0 || t2-t1<best_ref) best_ref=t2-t1;
+        }
+        printf("Fused best: %.6f ms, unfused best: %.6f ms (speedup %.3f), max difference %.3e\n",
+               best,best_ref,best_ref/best,max_diff);
+        free(b); free(res); free(slots);
+    }
+
+    // ------------------ Run eigen modes (-eig) -----------
+    if(eig && !lanczos){
+        double *v=malloc((size_t)rows*sizeof(double));
+        double lambda=0.0; int it=0;
+        for(int r=0;r<runs;r++){
+            double t0=get_ms();
+            it=sellcs_power(S,prec,maxit,tol,v,y,&lambda);
+            times[r]=get_ms()-t0;
+            printf("Run %d: %.6f ms   (%d iterations, %.1f iterations/s)\n",r+1,times[r],it,it/(times[r]/1000.0));
+        }
+        printf("Power iteration: largest |lambda| Rayleigh quotient %.12e after %d iterations%s\n",
+               lambda,it,it==maxit?" (not converged)":"");
+        free(v);
+    }
+    if(lanczos){
+        int m = maxit<rows ? maxit : (int)rows;
+        int h_stride=(m+7)&~7;
+        double *V=malloc((size_t)rows*m*sizeof(double));
+        double *alpha=malloc((size_t)m*sizeof(double)), *beta=malloc((size_t)m*sizeof(double));
+        double *h=malloc((size_t)m*sizeof(double));
+        double *h_part=malloc((size_t)omp_get_max_threads()*h_stride*sizeof(double));
+        if(!V || !alpha || !beta || !h || !h_part){ printf("Error: memory allocation failed for Lanczos basis.\n"); return 1; }
+        int steps=0; double spmv_ms=0.0, orth_ms=0.0;
+        for(int r=0;r<runs;r++){
+            double t0=get_ms();
+            steps=sellcs_lanczos(S,prec,m,alpha,beta,V,y,h,h_part,h_stride,&spmv_ms,&orth_ms);
+            times[r]=get_ms()-t0;
+            printf("Run %d: %.6f ms   (%d steps, %.1f iterations/s)\n",r+1,times[r],steps,steps/(times[r]/1000.0));
+        }
+        printf("Lanczos (last run): SpMV %.6f ms, reorthogonalization %.6f ms\n",spmv_ms,orth_ms);
+        // Ritz values of the last run (alpha/beta are no longer needed)
+        if(!tridiag_eigenvalues(alpha,beta,steps)) printf("Warning: QL iteration did not converge for all Ritz values.\n");
+        int shown = nev<steps ? nev : steps;
+        printf("Largest Ritz values: ");
+        for(int j=0;j<shown;j++) printf("%.12e ",alpha[steps-1-j]);
+        printf("\nSmallest Ritz values:");
+        for(int j=0;j<shown;j++) printf(" %.12e",alpha[j]);
+        printf("\n");
+        free(V); free(alpha); free(beta); free(h); free(h_part);
+    }
 
     // ------------------ Run SpMV -------------------------
-    for(int r=0;r<runs;r++){
-        for(int j=0;j<cols;j++) x[j]=(double)rand()/RAND_MAX;
+    if(pf==PF_AUTO) pf=sellcs_pf_sweep(S,x,y,runs);
+    for(int r=0;r<runs && nv==1 && !solve && !eig && !op_dot && !op_res;r++){
+        for(idx_t j=0;j<cols;j++) x[j]=(double)rand()/RAND_MAX;
         double t0=get_ms();
-        sellcs_spmv(S,x,y);
+        if(pf>0) sellcs_spmv_pf(S,x,y,pf);
+        else if(nt_store) sellcs_spmv_nt(S,x,y);
+        else sellcs_spmv_prec(S,prec,x,y);
         double t1=get_ms();
         times[r]=t1-t0;
         printf("Run %d: %.6f ms\n",r+1,times[r]);
@@ -190,10 +1209,12 @@ int main(int argc, char **argv){
     fclose(fp);
 
     // ------------------ Cleanup ------------------------
-    free(rowptr); free(csr_col); free(csr_val);
-    free(S->slice_ptr); free(S->slice_lengths);
-    free(S->col_idx); free(S->values); free(S);
-    free(x); free(y); free(times);
+    arena_free(rowptr); arena_free(csr_col); arena_free(csr_val);
+    arena_free(S->slice_ptr); arena_free(S->slice_lengths); arena_free(S->perm);
+    arena_free(S->col_idx); arena_free(S->values);
+    arena_free(S->values_f); arena_free(S->values_h); free(S);
+    arena_free(x); arena_free(y); free(times);
+    arena_release();
 
     return 0;
 }
@@ -0,0 +1,676 @@
+// Build with -fopenmp (gcc) or /openmp (MSVC)
+// Sparse triangular solve (SpTRSV) on the lower triangle of the matrix:
+// forward substitution L x = b and backward substitution L^T x = b, as used
+// by Gauss-Seidel and ILU(0)/IC(0) preconditioners. A level-set analysis
+// groups rows into independent wavefronts; the solve then runs either with
+// a barrier per level or sync-free with per-row completion flags.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <omp.h>
+#include <inttypes.h>
+#include <limits.h>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sched.h>
+#define SPIN_YIELD() sched_yield()
+#else
+#define SPIN_YIELD() ((void)0)
+#endif
+
+// Busy-wait iterations on a done flag before yielding the core; only matters
+// when there are more threads than cores
+#define SPIN_LIMIT 1000
+
+// ---------- Index width ----------
+// Two index types: nnz_t counts and addresses nonzeros (rowPtr, nnz), idx_t
+// holds rows and columns (colIndex, triplet indices). Both are 32-bit by
+// default. -DMVM_INDEX64 widens nnz_t only, for matrices with more than
+// 2^31 - 1 nonzeros, so colIndex stays at 4 bytes per nonzero. -DMVM_COL64
+// also widens idx_t, for dimensions beyond 2^31 - 1 (the loader tells you
+// which one a matrix needs).
+#if defined(MVM_INDEX64) || defined(MVM_COL64)
+typedef int64_t nnz_t;
+#define NNZ_FMT "%" PRId64
+#define NNZ_MAX INT64_MAX
+#else
+typedef int nnz_t;
+#define NNZ_FMT "%d"
+#define NNZ_MAX INT_MAX
+#endif
+#ifdef MVM_COL64
+typedef int64_t idx_t;
+#define IDX_FMT "%" PRId64
+#define IDX_SCN "%" SCNd64
+#define IDX_MAX INT64_MAX
+#else
+typedef int idx_t;
+#define IDX_FMT "%d"
+#define IDX_SCN "%d"
+#define IDX_MAX INT_MAX
+#endif
+
+typedef struct {
+    idx_t row;
+    idx_t col;
+    double val;
+} Triplet;
+
+// ---------- Quick Sort ----------
+int cmpTriplet(const void *a, const void *b) {
+    const Triplet *ta = (const Triplet *)a;
+    const Triplet *tb = (const Triplet *)b;
+    if (ta->row != tb->row) return (ta->row > tb->row) - (ta->row < tb->row);
+    return (ta->col > tb->col) - (ta->col < tb->col);
+}
+
+// ---------- CSR Conversion ----------
+void convertToCSR(Triplet *triplets, nnz_t nnz, idx_t rows, idx_t cols,
+                  double **values, idx_t **colIndex, nnz_t **rowPtr) {
+    *values = (double *)malloc((size_t)nnz * sizeof(double));
+    *colIndex = (idx_t *)malloc((size_t)nnz * sizeof(idx_t));
+    *rowPtr = (nnz_t *)calloc((size_t)rows + 1, sizeof(nnz_t));
+
+    if (!(*values) || !(*colIndex) || !(*rowPtr)) {
+        printf("Error: memory allocation failed in CSR conversion.\n");
+        fflush(stdout);
+        exit(1);
+    }
+
+    for (nnz_t i = 0; i < nnz; i++) {
+        (*rowPtr)[triplets[i].row + 1]++;
+    }
+    for (idx_t i = 0; i < rows; i++) {
+        (*rowPtr)[i + 1] += (*rowPtr)[i];
+    }
+
+    // We fill from the end of each row bucket, so make a copy of rowPtr to use as write pointers
+    nnz_t *writePtr = (nnz_t *)malloc(((size_t)rows + 1) * sizeof(nnz_t));
+    if (!writePtr) {
+        printf("Error: memory allocation failed in CSR conversion (writePtr).\n");
+        fflush(stdout);
+        exit(1);
+    }
+    for (idx_t i = 0; i <= rows; i++) writePtr[i] = (*rowPtr)[i];
+
+    for (nnz_t i = 0; i < nnz; i++) {
+        idx_t row = triplets[i].row;
+        nnz_t dest = writePtr[row];
+        (*values)[dest] = triplets[i].val;
+        (*colIndex)[dest] = triplets[i].col;
+        writePtr[row]++;
+    }
+
+    free(writePtr);
+}
+
+
+// ---------- Time in milliseconds ----------
+double getMilliseconds() {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);  // get current time in UTC
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6; // convert to milliseconds
+}
+
+
+// ---------- Triangular matrix with level sets ----------
+// The strictly off-diagonal part is kept in CSR and the diagonal separately,
+// so forward (L) and backward (U = L^T) solves share all code: row i needs
+// x[j] for every column j in its row, and the level sets encode the direction.
+typedef struct {
+    idx_t n;
+    int upper;          // 0: L, solved top-down; 1: U, solved bottom-up
+    nnz_t *rowPtr;
+    idx_t *colIndex;
+    double *values;
+    double *diag;
+    idx_t nlevels;
+    idx_t *levelPtr;    // rows of level l are order[levelPtr[l] .. levelPtr[l+1])
+    idx_t *order;       // rows sorted by level
+} TriMatrix;
+
+// Lower triangle of A (including the diagonal). Missing or zero diagonal
+// entries are replaced by 1 so the solve stays defined; the count is returned.
+idx_t extractLower(idx_t n, double *values, idx_t *colIndex, nnz_t *rowPtr, TriMatrix *L) {
+    memset(L, 0, sizeof(*L));
+    L->n = n;
+    L->rowPtr = (nnz_t *)malloc(((size_t)n + 1) * sizeof(nnz_t));
+    L->diag = (double *)malloc((size_t)n * sizeof(double));
+    nnz_t cnt = 0;
+    idx_t fixed = 0;
+    for (idx_t i = 0; i < n; i++)
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++)
+            if (colIndex[j] < i) cnt++;
+    L->colIndex = (idx_t *)malloc((size_t)(cnt ? cnt : 1) * sizeof(idx_t));
+    L->values = (double *)malloc((size_t)(cnt ? cnt : 1) * sizeof(double));
+    if (!L->rowPtr || !L->diag || !L->colIndex || !L->values) {
+        printf("Error: memory allocation failed for the triangular factor.\n");
+        fflush(stdout);
+        exit(1);
+    }
+    nnz_t pos = 0;
+    L->rowPtr[0] = 0;
+    for (idx_t i = 0; i < n; i++) {
+        double d = 0.0;
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++) {
+            if (colIndex[j] < i) {
+                L->colIndex[pos] = colIndex[j];
+                L->values[pos] = values[j];
+                pos++;
+            } else if (colIndex[j] == i) {
+                d += values[j];
+            }
+        }
+        if (d == 0.0) { d = 1.0; fixed++; }
+        L->diag[i] = d;
+        L->rowPtr[i + 1] = pos;
+    }
+    return fixed;
+}
+
+// U = L^T, built by counting entries per column of L
+void transposeTri(const TriMatrix *L, TriMatrix *U) {
+    idx_t n = L->n;
+    nnz_t nnz = L->rowPtr[n];
+    memset(U, 0, sizeof(*U));
+    U->n = n;
+    U->upper = 1;
+    U->rowPtr = (nnz_t *)calloc((size_t)n + 1, sizeof(nnz_t));
+    U->colIndex = (idx_t *)malloc((size_t)(nnz ? nnz : 1) * sizeof(idx_t));
+    U->values = (double *)malloc((size_t)(nnz ? nnz : 1) * sizeof(double));
+    U->diag = (double *)malloc((size_t)n * sizeof(double));
+    nnz_t *next = (nnz_t *)malloc(((size_t)n + 1) * sizeof(nnz_t));
+    if (!U->rowPtr || !U->colIndex || !U->values || !U->diag || !next) {
+        printf("Error: memory allocation failed for the transposed factor.\n");
+        fflush(stdout);
+        exit(1);
+    }
+    for (nnz_t j = 0; j < nnz; j++) U->rowPtr[L->colIndex[j] + 1]++;
+    for (idx_t i = 0; i < n; i++) U->rowPtr[i + 1] += U->rowPtr[i];
+    memcpy(next, U->rowPtr, ((size_t)n + 1) * sizeof(nnz_t));
+    for (idx_t i = 0; i < n; i++) {
+        for (nnz_t j = L->rowPtr[i]; j < L->rowPtr[i + 1]; j++) {
+            nnz_t dest = next[L->colIndex[j]]++;
+            U->colIndex[dest] = i;
+            U->values[dest] = L->values[j];
+        }
+    }
+    memcpy(U->diag, L->diag, (size_t)n * sizeof(double));
+    free(next);
+}
+
+// level[i] = 1 + max level of the rows it depends on, visiting rows in
+// dependency order; then a counting sort groups the rows by level.
+void buildLevels(TriMatrix *T) {
+    idx_t n = T->n;
+    idx_t *level = (idx_t *)malloc((size_t)n * sizeof(idx_t));
+    T->order = (idx_t *)malloc((size_t)n * sizeof(idx_t));
+    if (!level || !T->order) {
+        printf("Error: memory allocation failed for level sets.\n");
+        fflush(stdout);
+        exit(1);
+    }
+    idx_t nlevels = 0;
+    for (idx_t k = 0; k < n; k++) {
+        idx_t i = T->upper ? n - 1 - k : k;
+        idx_t lv = 0;
+        for (nnz_t j = T->rowPtr[i]; j < T->rowPtr[i + 1]; j++)
+            if (level[T->colIndex[j]] + 1 > lv) lv = level[T->colIndex[j]] + 1;
+        level[i] = lv;
+        if (lv + 1 > nlevels) nlevels = lv + 1;
+    }
+    T->nlevels = nlevels;
+    T->levelPtr = (idx_t *)calloc((size_t)nlevels + 1, sizeof(idx_t));
+    for (idx_t i = 0; i < n; i++) T->levelPtr[level[i] + 1]++;
+    for (idx_t l = 0; l < nlevels; l++) T->levelPtr[l + 1] += T->levelPtr[l];
+    idx_t *next = (idx_t *)malloc((size_t)nlevels * sizeof(idx_t));
+    memcpy(next, T->levelPtr, (size_t)nlevels * sizeof(idx_t));
+    for (idx_t i = 0; i < n; i++) T->order[next[level[i]]++] = i;
+    free(next);
+    free(level);
+}
+
+void freeTri(TriMatrix *T) {
+    free(T->rowPtr); free(T->colIndex); free(T->values); free(T->diag);
+    free(T->levelPtr); free(T->order);
+}
+
+// ---------- Triangular solves ----------
+static inline double solveRow(const TriMatrix *T, idx_t i, const double *b, const double *x) {
+    double sum = b[i];
+    for (nnz_t j = T->rowPtr[i]; j < T->rowPtr[i + 1]; j++)
+        sum -= T->values[j] * x[T->colIndex[j]];
+    return sum / T->diag[i];
+}
+
+// Sequential substitution in natural order (reference)
+void triSolveSequential(const TriMatrix *T, const double *b, double *x) {
+    for (idx_t k = 0; k < T->n; k++) {
+        idx_t i = T->upper ? T->n - 1 - k : k;
+        x[i] = solveRow(T, i, b, x);
+    }
+}
+
+// Level-set schedule: the rows of a level are independent, the implicit
+// barrier of each omp for separates the levels.
+void triSolveLevel(const TriMatrix *T, const double *b, double *x) {
+    #pragma omp parallel
+    {
+        for (idx_t l = 0; l < T->nlevels; l++) {
+            #pragma omp for schedule(runtime)
+            for (idx_t k = T->levelPtr[l]; k < T->levelPtr[l + 1]; k++) {
+                idx_t i = T->order[k];
+                x[i] = solveRow(T, i, b, x);
+            }
+        }
+    }
+}
+
+// Sync-free schedule: no barriers. Thread t takes every nthreads-th row of the
+// level-ordered list and, for each dependency, spins on that row's done flag.
+// Every thread walks its rows in level order and dependencies always sit at a
+// lower level, so some thread can always make progress. done[] holds the id of
+// the solve that finished the row, so the flags never need resetting.
+void triSolveSyncFree(const TriMatrix *T, const double *b, double *x, int *done, int solveId) {
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num(), nthreads = omp_get_num_threads();
+        for (idx_t k = t; k < T->n; k += nthreads) {
+            idx_t i = T->order[k];
+            double sum = b[i];
+            for (nnz_t j = T->rowPtr[i]; j < T->rowPtr[i + 1]; j++) {
+                idx_t c = T->colIndex[j];
+                int flag, spins = 0;
+                for (;;) {
+                    #pragma omp atomic read seq_cst
+                    flag = done[c];
+                    if (flag == solveId) break;
+                    if (++spins == SPIN_LIMIT) {
+                        SPIN_YIELD();
+                        spins = 0;
+                    }
+                }
+                sum -= T->values[j] * x[c];
+            }
+            x[i] = sum / T->diag[i];
+            #pragma omp atomic write seq_cst
+            done[i] = solveId;
+        }
+    }
+}
+
+// Level count and rows per level (the parallelism available to the level schedule)
+void reportLevels(const char *name, const TriMatrix *T, int threads, FILE *fp) {
+    idx_t minRows = T->n, maxRows = 0, narrow = 0;
+    for (idx_t l = 0; l < T->nlevels; l++) {
+        idx_t cnt = T->levelPtr[l + 1] - T->levelPtr[l];
+        if (cnt < minRows) minRows = cnt;
+        if (cnt > maxRows) maxRows = cnt;
+        if (cnt < threads) narrow++;
+        if (fp) fprintf(fp, "%s " IDX_FMT " " IDX_FMT "\n", name, l, cnt);
+    }
+    printf("  %s: " IDX_FMT " levels, rows per level avg %.1f, min " IDX_FMT ", max " IDX_FMT
+           ", " IDX_FMT " levels narrower than %d threads\n",
+           name, T->nlevels, (double)T->n / T->nlevels, minRows, maxRows, narrow, threads);
+}
+
+// ---------- Command-line utilities ----------
+void printUsage(const char *prog) {
+    printf("Usage: %s <matrix_file> [-r runs] [-t threads] [-s schedule] [-c chunk] [-m method] [-d direction]\n", prog);
+    printf("  -r runs      : number of runs (default 10)\n");
+    printf("  -t threads   : number of OpenMP threads (default = hardware)\n");
+    printf("  -s schedule  : schedule for the level loop: static | dynamic | guided | auto (default guided)\n");
+    printf("  -c chunk     : chunk size for schedule (integer, default 0)\n");
+    printf("  -m method    : solver timed in the Run lines: level | syncfree (default syncfree)\n");
+    printf("  -d direction : fwd = L x = b, bwd = L^T x = b (default fwd)\n");
+    printf("Example: %s bcsstk14.txt -r 20 -t 8 -m syncfree -d fwd\n", prog);
+}
+
+// Map schedule string to omp_sched_t
+int parseSchedule(const char *s, omp_sched_t *outKind) {
+    if (!s) return 0;
+    if (strcmp(s, "static") == 0) { *outKind = omp_sched_static; return 1; }
+    if (strcmp(s, "dynamic") == 0) { *outKind = omp_sched_dynamic; return 1; }
+    if (strcmp(s, "guided") == 0) { *outKind = omp_sched_guided; return 1; }
+    if (strcmp(s, "auto") == 0)   { *outKind = omp_sched_auto;   return 1; }
+    return 0;
+}
+
+
+// ---------- Main ----------
+int main(int argc, char *argv[]) {
+    printf("=== Sparse Triangular Solve Program Starting ===\n");
+    fflush(stdout);
+
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Defaults
+    char *filename = argv[1];
+    int runs = 10;
+    int threads = 0; // 0 means leave to OpenMP default/hardware
+    const char *schedStr = "guided";
+    int chunk = 0;
+    int syncFree = 1;
+    int upper = 0;
+
+    // Parse optional args
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+            if (runs <= 0) runs = 10;
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+            if (threads < 0) threads = 0;
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            schedStr = argv[++i];
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            chunk = atoi(argv[++i]);
+            if (chunk < 0) chunk = 0;
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            const char *m = argv[++i];
+            if (strcmp(m, "syncfree") == 0) syncFree = 1;
+            else if (strcmp(m, "level") == 0) syncFree = 0;
+            else {
+                printf("Unknown method '%s'. Valid: level, syncfree\n", m);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            const char *d = argv[++i];
+            if (strcmp(d, "fwd") == 0) upper = 0;
+            else if (strcmp(d, "bwd") == 0) upper = 1;
+            else {
+                printf("Unknown direction '%s'. Valid: fwd, bwd\n", d);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            printf("Unknown option: %s\n", argv[i]);
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    printf("Attempting to open file: %s\n", filename);
+    fflush(stdout);
+
+    FILE *fin = fopen(filename, "r");
+    if (!fin) {
+        printf("Error: cannot open file '%s'\n", filename);
+        fflush(stdout);
+        return 1;
+    }
+
+    printf("File opened successfully!\n");
+    fflush(stdout);
+
+    // Skip all comment lines starting with %
+    int comment_count = 0;
+    int ch;
+    while ((ch = fgetc(fin)) != EOF) {
+        if (ch == '%') {
+            while ((ch = fgetc(fin)) != EOF && ch != '\n');
+            comment_count++;
+        } else {
+            ungetc(ch, fin);
+            break;
+        }
+    }
+
+    printf("Skipped %d comment line(s).\n", comment_count);
+    fflush(stdout);
+
+    if (ch == EOF) {
+        printf("Error: file contains only comments or is empty.\n");
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+
+    printf("Reading matrix header...\n");
+    fflush(stdout);
+
+    long long hdrRows, hdrCols, hdrNnz;
+    if (fscanf(fin, "%lld %lld %lld", &hdrRows, &hdrCols, &hdrNnz) != 3) {
+        printf("Error: invalid matrix header.\n");
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+
+    printf("Matrix dimensions: %lld x %lld with %lld non-zero elements\n", hdrRows, hdrCols, hdrNnz);
+    fflush(stdout);
+
+    if (hdrRows <= 0 || hdrCols <= 0 || hdrNnz <= 0) {
+        printf("Error: invalid matrix dimensions (must be positive).\n");
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+    if (hdrNnz > NNZ_MAX) {
+        printf("Error: %lld nonzeros do not fit in %d-bit offsets, rebuild with -DMVM_INDEX64.\n",
+               hdrNnz, (int)(8 * sizeof(nnz_t)));
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+    if (hdrRows > IDX_MAX || hdrCols > IDX_MAX) {
+        printf("Error: matrix dimensions do not fit in %d-bit indices, rebuild with -DMVM_COL64.\n",
+               (int)(8 * sizeof(idx_t)));
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+    idx_t rows = (idx_t)hdrRows, cols = (idx_t)hdrCols;
+    nnz_t nnz = (nnz_t)hdrNnz;
+
+    Triplet *triplets = (Triplet *)malloc((size_t)nnz * sizeof(Triplet));
+    if (!triplets) {
+        printf("Error: memory allocation failed for triplets.\n");
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+
+    printf("Reading matrix elements...\n");
+    fflush(stdout);
+
+    idx_t maxRow = 0, maxCol = 0;
+
+    for (nnz_t i = 0; i < nnz; i++) {
+        if (fscanf(fin, IDX_SCN " " IDX_SCN " %lf", &triplets[i].row, &triplets[i].col, &triplets[i].val) != 3) {
+            printf("Error: invalid matrix element at entry " NNZ_FMT ".\n", i + 1);
+            fflush(stdout);
+            fclose(fin);
+            free(triplets);
+            return 1;
+        }
+        if (triplets[i].row > maxRow) maxRow = triplets[i].row;
+        if (triplets[i].col > maxCol) maxCol = triplets[i].col;
+    }
+
+    // If indices are 1-based, subtract 1 from all
+    if (maxRow == rows || maxCol == cols) {
+        printf("Detected 1-based indexing, converting to 0-based...\n");
+        fflush(stdout);
+        for (nnz_t i = 0; i < nnz; i++) {
+            triplets[i].row--;
+            triplets[i].col--;
+        }
+    }
+
+    // Validate indices
+    for (nnz_t i = 0; i < nnz; i++) {
+        if (triplets[i].row < 0 || triplets[i].row >= rows ||
+            triplets[i].col < 0 || triplets[i].col >= cols) {
+            printf("Error: invalid indices at entry " NNZ_FMT " (row=" IDX_FMT ", col=" IDX_FMT ")\n",
+                   i + 1, triplets[i].row, triplets[i].col);
+            fflush(stdout);
+            fclose(fin);
+            free(triplets);
+            return 1;
+        }
+    }
+    fclose(fin);
+    printf("Matrix data loaded successfully!\n");
+    fflush(stdout);
+
+    printf("Sorting triplets using qsort...\n");
+    fflush(stdout);
+    qsort(triplets, (size_t)nnz, sizeof(Triplet), cmpTriplet);
+
+    printf("Converting to CSR format...\n");
+    fflush(stdout);
+    double *values;
+    idx_t *colIndex;
+    nnz_t *rowPtr;
+    convertToCSR(triplets, nnz, rows, cols, &values, &colIndex, &rowPtr);
+    if (rows != cols) {
+        printf("Error: the triangular solve needs a square matrix.\n");
+        fflush(stdout);
+        return 1;
+    }
+
+    TriMatrix L, U;
+    double anaStart = getMilliseconds();
+    idx_t fixedDiag = extractLower(rows, values, colIndex, rowPtr, &L);
+    transposeTri(&L, &U);
+    buildLevels(&L);
+    buildLevels(&U);
+    double anaEnd = getMilliseconds();
+    if (fixedDiag > 0)
+        printf("Warning: " IDX_FMT " rows had no diagonal entry, using 1.0\n", fixedDiag);
+
+    printf("Allocating vectors...\n");
+    fflush(stdout);
+    double *b = (double *)malloc((size_t)rows * sizeof(double));
+    double *x = (double *)malloc((size_t)rows * sizeof(double));
+    double *xRef = (double *)malloc((size_t)rows * sizeof(double));
+    double *xOther = (double *)malloc((size_t)rows * sizeof(double)); // the solver not in the Run lines
+    int *done = (int *)calloc((size_t)rows, sizeof(int));
+    double *times = (double *)malloc(runs * sizeof(double));
+    if (!b || !x || !xRef || !xOther || !done || !times) {
+        printf("Error: memory allocation failed for vectors.\n");
+        fflush(stdout);
+        return 1;
+    }
+
+    // Configure OpenMP runtime scheduling based on user input
+    omp_sched_t schedKind;
+    if (!parseSchedule(schedStr, &schedKind)) {
+        printf("Unknown schedule '%s'. Valid: static, dynamic, guided, auto\n", schedStr);
+        return 1;
+    }
+
+    if (threads > 0) {
+        omp_set_num_threads(threads);
+    }
+    omp_set_schedule(schedKind, chunk);
+
+    int usedThreads = omp_get_max_threads();
+    printf("\nRuntime configuration:\n");
+    printf("  Runs: %d\n", runs);
+    printf("  Threads (omp_get_max_threads): %d\n", usedThreads);
+    printf("  Schedule: %s  chunk=%d\n", schedStr, chunk);
+    printf("  Method: %s  direction: %s\n", syncFree ? "syncfree" : "level", upper ? "bwd (L^T)" : "fwd (L)");
+    fflush(stdout);
+
+    printf("\nLevel-set analysis (%.6f ms, both directions):\n", anaEnd - anaStart);
+    FILE *lf = fopen("levels.txt", "w");
+    if (lf) fprintf(lf, "# direction level rows\n");
+    reportLevels("fwd", &L, usedThreads, lf);
+    reportLevels("bwd", &U, usedThreads, lf);
+    if (lf) {
+        fclose(lf);
+        printf("  Rows per level written to levels.txt\n");
+    }
+    fflush(stdout);
+
+    const TriMatrix *T = upper ? &U : &L;
+    srand((unsigned int)time(NULL));
+
+    printf("\nRunning %d triangular solves (parallel, sequential reference)...\n", runs);
+    fflush(stdout);
+
+    double best = 0.0, bestSeq = 0.0, bestOther = 0.0, maxDiff = 0.0;
+    for (int r = 0; r < runs; r++) {
+        for (idx_t i = 0; i < rows; i++)
+            b[i] = (double)rand() / RAND_MAX;
+
+        double t0 = getMilliseconds();
+        triSolveSequential(T, b, xRef);
+        double t1 = getMilliseconds();
+        if (syncFree) triSolveLevel(T, b, xOther);
+        else triSolveSyncFree(T, b, xOther, done, r + 1);
+        double t2 = getMilliseconds();
+        if (syncFree) triSolveSyncFree(T, b, x, done, r + 1);
+        else triSolveLevel(T, b, x);
+        double t3 = getMilliseconds();
+
+        // Both parallel solvers are checked against the sequential one
+        double diff = 0.0, norm = 0.0;
+        for (idx_t i = 0; i < rows; i++) {
+            if (fabs(x[i] - xRef[i]) > diff) diff = fabs(x[i] - xRef[i]);
+            if (fabs(xOther[i] - xRef[i]) > diff) diff = fabs(xOther[i] - xRef[i]);
+            if (fabs(xRef[i]) > norm) norm = fabs(xRef[i]);
+        }
+        if (norm > 0.0) diff /= norm;
+        if (diff > maxDiff) maxDiff = diff;
+
+        times[r] = t3 - t2;
+        printf("Run %d: %.6f ms   (sequential: %.6f ms, %s: %.6f ms)\n",
+               r + 1, times[r], t1 - t0, syncFree ? "level" : "syncfree", t2 - t1);
+        fflush(stdout);
+        if (r == 0 || times[r] < best) best = times[r];
+        if (r == 0 || t1 - t0 < bestSeq) bestSeq = t1 - t0;
+        if (r == 0 || t2 - t1 < bestOther) bestOther = t2 - t1;
+    }
+
+    printf("\nBest run: sequential %.6f ms, %s %.6f ms (speedup %.3f), %s %.6f ms (speedup %.3f)\n",
+           bestSeq, syncFree ? "syncfree" : "level", best, bestSeq / best,
+           syncFree ? "level" : "syncfree", bestOther, bestSeq / bestOther);
+    printf("Max relative difference vs sequential (both solvers): %.3e\n", maxDiff);
+    fflush(stdout);
+
+    printf("Saving all %d runs to file...\n", runs);
+    fflush(stdout);
+
+    FILE *fp = fopen("all_runs.txt", "w");
+    if (fp) {
+        fprintf(fp, "All %d runs (in ms) - SpTRSV %s %s:\n", runs, syncFree ? "syncfree" : "level", upper ? "bwd" : "fwd");
+        for (int i = 0; i < runs; i++) {
+            fprintf(fp, "%.6f\n", times[i]);
+        }
+        fclose(fp);
+        printf("\n=== Success! ===\n");
+        printf("All %d runs saved to all_runs.txt\n", runs);
+        fflush(stdout);
+    } else {
+        printf("Error: could not create output file all_runs.txt\n");
+        fflush(stdout);
+    }
+
+    freeTri(&L);
+    freeTri(&U);
+    free(triplets);
+    free(values);
+    free(colIndex);
+    free(rowPtr);
+    free(b);
+    free(x);
+    free(xRef);
+    free(xOther);
+    free(done);
+    free(times);
+
+    printf("Program completed successfully.\n");
+    fflush(stdout);
+    return 0;
+}
@@ -1,11 +1,42 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <limits.h>
+
+// ---------- Index width ----------
+// Two index types: nnz_t counts and addresses nonzeros (rowPtr, nnz), idx_t
+// holds rows and columns (colIndex, triplet indices). Both are 32-bit by
+// default. -DMVM_INDEX64 widens nnz_t only, for matrices with more than
+// 2^31 - 1 nonzeros, so colIndex stays at 4 bytes per nonzero. -DMVM_COL64
+// also widens idx_t, for dimensions beyond 2^31 - 1 (the loader tells you
+// which one a matrix needs).
+#if defined(MVM_INDEX64) || defined(MVM_COL64)
+typedef int64_t nnz_t;
+#define NNZ_FMT "%" PRId64
+#define NNZ_MAX INT64_MAX
+#else
+typedef int nnz_t;
+#define NNZ_FMT "%d"
+#define NNZ_MAX INT_MAX
+#endif
+#ifdef MVM_COL64
+typedef int64_t idx_t;
+#define IDX_FMT "%" PRId64
+#define IDX_SCN "%" SCNd64
+#define IDX_MAX INT64_MAX
+#else
+typedef int idx_t;
+#define IDX_FMT "%d"
+#define IDX_SCN "%d"
+#define IDX_MAX INT_MAX
+#endif
 
 
 typedef struct {
-    int row;
-    int col;
+    idx_t row;
+    idx_t col;
     double val;
 } Triplet;
 
@@ -16,16 +47,16 @@ typedef struct {
 
     // Sort by row first, then by column for deterministic CSR
     if (ta->row != tb->row)
-        return ta->row - tb->row;
-    return ta->col - tb->col;
+        return (ta->row > tb->row) - (ta->row < tb->row);
+    return (ta->col > tb->col) - (ta->col < tb->col);
 }
 
 // ---------- CSR Conversion ----------
-void convertToCSR(Triplet *triplets, int nnz, int rows, int cols,
-                  double **values, int **colIndex, int **rowPtr) {
-    *values = (double *)malloc(nnz * sizeof(double));
-    *colIndex = (int *)malloc(nnz * sizeof(int));
-    *rowPtr = (int *)calloc((rows + 1), sizeof(int));
+void convertToCSR(Triplet *triplets, nnz_t nnz, idx_t rows, idx_t cols,
+                  double **values, idx_t **colIndex, nnz_t **rowPtr) {
+    *values = (double *)malloc((size_t)nnz * sizeof(double));
+    *colIndex = (idx_t *)malloc((size_t)nnz * sizeof(idx_t));
+    *rowPtr = (nnz_t *)calloc((size_t)rows + 1, sizeof(nnz_t));
 
     if (!(*values) || !(*colIndex) || !(*rowPtr)) {
         printf("Error: memory allocation failed in CSR conversion.\n");
@@ -33,16 +64,16 @@ void convertToCSR(Triplet *triplets, int nnz, int rows, int cols,
         exit(1);
     }
 
-    for (int i = 0; i < nnz; i++) {
+    for (nnz_t i = 0; i < nnz; i++) {
         (*rowPtr)[triplets[i].row + 1]++;
     }
-    for (int i = 0; i < rows; i++) {
+    for (idx_t i = 0; i < rows; i++) {
         (*rowPtr)[i + 1] += (*rowPtr)[i];
     }
 
-    for (int i = 0; i < nnz; i++) {
-        int row = triplets[i].row;
-        int dest = (*rowPtr)[row + 1] - 1;
+    for (nnz_t i = 0; i < nnz; i++) {
+        idx_t row = triplets[i].row;
+        nnz_t dest = (*rowPtr)[row + 1] - 1;
         (*values)[dest] = triplets[i].val;
         (*colIndex)[dest] = triplets[i].col;
         (*rowPtr)[row + 1]--;
@@ -50,11 +81,11 @@ void convertToCSR(Triplet *triplets, int nnz, int rows, int cols,
 }
 
 // ---------- Matrix-Vector Multiplication ----------
-void csrMatVecMultiply(int rows, double *values, int *colIndex, int *rowPtr,
+void csrMatVecMultiply(idx_t rows, double *values, idx_t *colIndex, nnz_t *rowPtr,
                        double *x, double *y) {
-    for (int i = 0; i < rows; i++) {
+    for (idx_t i = 0; i < rows; i++) {
         double sum = 0.0;
-        for (int j = rowPtr[i]; j < rowPtr[i + 1]; j++) {
+        for (nnz_t j = rowPtr[i]; j < rowPtr[i + 1]; j++) {
             sum += values[j] * x[colIndex[j]];
         }
         y[i] = sum;
@@ -130,8 +161,8 @@ int main(int argc, char *argv[]) {
     printf("Reading matrix header...\n");
     fflush(stdout);
 
-    int rows, cols, nnz;
-    if (fscanf(fin, "%d %d %d", &rows, &cols, &nnz) != 3) {
+    long long hdrRows, hdrCols, hdrNnz;
+    if (fscanf(fin, "%lld %lld %lld", &hdrRows, &hdrCols, &hdrNnz) != 3) {
         printf("Error: invalid matrix header.\n");
         printf("Expected format: rows cols nnz\n");
         fflush(stdout);
@@ -139,20 +170,36 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    printf("Matrix dimensions: %d x %d with %d non-zero elements\n", rows, cols, nnz);
+    printf("Matrix dimensions: %lld x %lld with %lld non-zero elements\n", hdrRows, hdrCols, hdrNnz);
     fflush(stdout);
 
-    if (rows <= 0 || cols <= 0 || nnz <= 0) {
+    if (hdrRows <= 0 || hdrCols <= 0 || hdrNnz <= 0) {
         printf("Error: invalid matrix dimensions (must be positive).\n");
         fflush(stdout);
         fclose(fin);
         return 1;
     }
+    if (hdrNnz > NNZ_MAX) {
+        printf("Error: %lld nonzeros do not fit in %d-bit offsets, rebuild with -DMVM_INDEX64.\n",
+               hdrNnz, (int)(8 * sizeof(nnz_t)));
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+    if (hdrRows > IDX_MAX || hdrCols > IDX_MAX) {
+        printf("Error: matrix dimensions do not fit in %d-bit indices, rebuild with -DMVM_COL64.\n",
+               (int)(8 * sizeof(idx_t)));
+        fflush(stdout);
+        fclose(fin);
+        return 1;
+    }
+    idx_t rows = (idx_t)hdrRows, cols = (idx_t)hdrCols;
+    nnz_t nnz = (nnz_t)hdrNnz;
 
     printf("Allocating memory for triplets...\n");
     fflush(stdout);
 
-    Triplet *triplets = (Triplet *)malloc(nnz * sizeof(Triplet));
+    Triplet *triplets = (Triplet *)malloc((size_t)nnz * sizeof(Triplet));
     if (!triplets) {
         printf("Error: memory allocation failed for triplets.\n");
         fflush(stdout);
@@ -163,11 +210,11 @@ int main(int argc, char *argv[]) {
     printf("Reading matrix elements...\n");
     fflush(stdout);
 
-    int maxRow = 0, maxCol = 0;
+    idx_t maxRow = 0, maxCol = 0;
 
-    for (int i = 0; i < nnz; i++) {
-        if (fscanf(fin, "%d %d %lf", &triplets[i].row, &triplets[i].col, &triplets[i].val) != 3) {
-            printf("Error: invalid matrix element at entry %d.\n", i + 1);
+    for (nnz_t i = 0; i < nnz; i++) {
+        if (fscanf(fin, IDX_SCN " " IDX_SCN " %lf", &triplets[i].row, &triplets[i].col, &triplets[i].val) != 3) {
+            printf("Error: invalid matrix element at entry " NNZ_FMT ".\n", i + 1);
             printf("Expected format: row col value\n");
             fflush(stdout);
             fclose(fin);
@@ -183,19 +230,19 @@ int main(int argc, char *argv[]) {
     if (maxRow == rows || maxCol == cols) {
         printf("Detected 1-based indexing, converting to 0-based...\n");
         fflush(stdout);
-        for (int i = 0; i < nnz; i++) {
+        for (nnz_t i = 0; i < nnz; i++) {
             triplets[i].row--;
             triplets[i].col--;
         }
     }
 
 // Now validate indices
-    for (int i = 0; i < nnz; i++) {
+    for (nnz_t i = 0; i < nnz; i++) {
         if (triplets[i].row < 0 || triplets[i].row >= rows || 
             triplets[i].col < 0 || triplets[i].col >= cols) {
-            printf("Error: invalid indices at entry %d (row=%d, col=%d)\n", 
+            printf("Error: invalid indices at entry " NNZ_FMT " (row=" IDX_FMT ", col=" IDX_FMT ")\n", 
                    i + 1, triplets[i].row, triplets[i].col);
-            printf("Valid ranges: row [0,%d), col [0,%d)\n", rows, cols);
+            printf("Valid ranges: row [0," IDX_FMT "), col [0," IDX_FMT ")\n", rows, cols);
             fflush(stdout);
             fclose(fin);
             free(triplets);
@@ -208,19 +255,20 @@ int main(int argc, char *argv[]) {
 
     printf("Sorting triplets using qsort...\n");
     fflush(stdout);
-    qsort(triplets, nnz, sizeof(Triplet), cmpTriplet);
+    qsort(triplets, (size_t)nnz, sizeof(Triplet), cmpTriplet);
 
     printf("Converting to CSR format...\n");
     fflush(stdout);
     double *values;
-    int *colIndex, *rowPtr;
+    idx_t *colIndex;
+    nnz_t *rowPtr;
     convertToCSR(triplets, nnz, rows, cols, &values, &colIndex, &rowPtr);
 
     printf("Allocating vectors...\n");
     fflush(stdout);
 
-    double *x = (double *)malloc(cols * sizeof(double));
-    double *y = (double *)malloc(rows * sizeof(double));
+    double *x = (double *)malloc((size_t)cols * sizeof(double));
+    double *y = (double *)malloc((size_t)rows * sizeof(double));
     double *times = (double *)malloc(runs * sizeof(double));
 
     if (!x || !y || !times) {
@@ -239,7 +287,7 @@ int main(int argc, char *argv[]) {
     fflush(stdout);
 
     for (int i = 0; i < runs; i++) {
-        for (int j = 0; j < cols; j++)
+        for (idx_t j = 0; j < cols; j++)
             x[j] = (double)rand() / RAND_MAX;
 
         double start = getMilliseconds();
@@ -28,6 +28,7 @@ schedules=("static" "dynamic" "guided")
 threads_list=(2 4 8 16 32)
 chunks=(1 2 4 8 16 32)
 sigmas=(64 128 256 512)  # sigma values for SELL-C
+reorders=("none" "rcm" "gorder")  # -reorder values, MVM_parallel only
 runs=12
 
 # ----------------------------
@@ -127,32 +128,45 @@ run_experiments() {
                     done
                 done
             else
-                # Regular parallel OpenMP codes
-                for sched in "${schedules[@]}"; do
-                    for th in "${threads_list[@]}"; do
-                        for ch in "${chunks[@]}"; do
-                            run_id=$(printf "%05d" $run_counter)
-                            current_run_dir="$RUNS_DIR/run_${run_id}_${matrix_name}_${sched}_t${th}_c${ch}"
-                            mkdir -p "$current_run_dir"
-                            ((run_counter++))
-
-                            stdout_file="$current_run_dir/stdout.txt"
-                            output=$("$C_PROGRAM" "$matrix" -r "$runs" -t "$th" -s "$sched" -c "$ch" 2>&1)
-                            echo "$output" > "$stdout_file"
-
-                            extract_times_from_stdout "$stdout_file" "$current_run_dir/times.txt"
-                            p90=$(percentile_90 "$current_run_dir/times.txt")
-
-                            printf "Schedule: %-7s | Threads: %-2d | Chunk: %-3d | 90th percentile: %s ms\n" \
-                                "$sched" "$th" "$ch" "$p90" >> "$RESULTS_FILE"
-
-                            if [[ "$p90" != "N/A" && "$p90" != "" ]]; then
-                                key="${matrix_name}:${C_PROGRAM}"
-                                if [[ -z "${best_par[$key]}" || 1 -eq "$(echo "$p90 < ${best_par[$key]}" | bc)" ]]; then
-                                    best_par[$key]="$p90"
-                                    best_par_config[$key]="${sched},${th},${ch}"
+                # Regular parallel OpenMP codes; only MVM_parallel takes -reorder
+                reorder_list=("none")
+                [[ "$(basename "$C_PROGRAM")" == "MVM_parallel" ]] && reorder_list=("${reorders[@]}")
+                for ro in "${reorder_list[@]}"; do
+                    for sched in "${schedules[@]}"; do
+                        for th in "${threads_list[@]}"; do
+                            for ch in "${chunks[@]}"; do
+                                run_id=$(printf "%05d" $run_counter)
+                                current_run_dir="$RUNS_DIR/run_${run_id}_${matrix_name}_${ro}_${sched}_t${th}_c${ch}"
+                                mkdir -p "$current_run_dir"
+                                ((run_counter++))
+
+                                stdout_file="$current_run_dir/stdout.txt"
+                                reorder_args=()
+                                [[ "$ro" != "none" ]] && reorder_args=(-reorder "$ro")
+                                output=$("$C_PROGRAM" "$matrix" -r "$runs" -t "$th" -s "$sched" -c "$ch" "${reorder_args[@]}" 2>&1)
+                                echo "$output" > "$stdout_file"
+
+                                extract_times_from_stdout "$stdout_file" "$current_run_dir/times.txt"
+                                p90=$(percentile_90 "$current_run_dir/times.txt")
+
+                                # Reordering cost is reported apart from the SpMV times
+                                reorder_ms=$(grep -Eo "^Reordering \([a-z]+\): [0-9.]+ ms" "$stdout_file" | awk '{print $3}')
+                                break_even=$(grep -Eo "Break-even: .*" "$stdout_file" | sed 's/Break-even: //')
+
+                                printf "Reorder: %-6s | Schedule: %-7s | Threads: %-2d | Chunk: %-3d | 90th percentile: %s ms" \
+                                    "$ro" "$sched" "$th" "$ch" "$p90" >> "$RESULTS_FILE"
+                                [[ -n "$reorder_ms" ]] && printf " | reorder: %s ms, break-even: %s" \
+                                    "$reorder_ms" "$break_even" >> "$RESULTS_FILE"
+                                printf "\n" >> "$RESULTS_FILE"
+
+                                if [[ "$p90" != "N/A" && "$p90" != "" ]]; then
+                                    key="${matrix_name}:${C_PROGRAM}"
+                                    if [[ -z "${best_par[$key]}" || 1 -eq "$(echo "$p90 < ${best_par[$key]}" | bc)" ]]; then
+                                        best_par[$key]="$p90"
+                                        best_par_config[$key]="${ro},${sched},${th},${ch}"
+                                    fi
                                 fi
-                            fi
+                            done
                         done
                     done
                 done